@@ -85,7 +85,7 @@
 // the system clock.  The value of the divider is determined by the table
 // above.
 //
-#define CFG_RCC_PWMDIV 7
+#define CFG_RCC_PWMDIV 0
 
 //      <q> PWRDN: PLL Power Down
 //          <i> Check this box to disable the PLL.  You must also choose
@@ -562,6 +562,9 @@ void SystemCoreClockUpdate (void)            /* Get Core Clock Frequency      */
     }
 }
 
+extern void bootProfileReset(void);
+extern void bootStamp(uint32_t stage);
+
 /**
  * Initialize the system
  *
@@ -577,6 +580,8 @@ void SystemInit (void)
     uint32_t i;
 #endif
 
+  bootProfileReset();
+
   /* FPU settings ------------------------------------------------------------*/
   #if (__FPU_USED == 1)
     SCB->CPACR |= ((3UL << 10*2) |                 /* set CP10 Full Access */
@@ -607,4 +612,6 @@ void SystemInit (void)
     for (i = 0; i < 10000; i++);   /* wait a while */
 
 #endif
+
+  bootStamp(1);                   /* BOOT_SYSTEMINIT */
 }
@@ -53,7 +53,7 @@ extern uint32_t SystemCoreClock;
 #define configTOTAL_HEAP_SIZE                 ((size_t)4096)
 #define configMINIMAL_STACK_SIZE              ((uint16_t)256)
 #define configSUPPORT_DYNAMIC_ALLOCATION      1
-#define configSUPPORT_STATIC_ALLOCATION       0
+#define configSUPPORT_STATIC_ALLOCATION       1
 
 /* Constants related to the behaviour or the scheduler. */
 #define configMAX_PRIORITIES                  5
@@ -64,10 +64,10 @@ extern uint32_t SystemCoreClock;
 #define configUSE_16_BIT_TICKS                0
 
 /* Software timer definitions. */
-#define configUSE_TIMERS                      0
-#define configTIMER_TASK_PRIORITY             2
-#define configTIMER_QUEUE_LENGTH              5
-#define configTIMER_TASK_STACK_DEPTH          (configMINIMAL_STACK_SIZE * 2)
+#define configUSE_TIMERS                      1
+#define configTIMER_TASK_PRIORITY             (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH              10
+#define configTIMER_TASK_STACK_DEPTH          (configMINIMAL_STACK_SIZE / 2)
 
 /* Constants that build features in or out. */
 #define configUSE_MUTEXES                     1
@@ -159,4 +159,9 @@ extern uint32_t SystemCoreClock;
 #include "freertos_evr.h"
 #endif
 
+#ifdef ENABLE_TRACE
+/* RAM trace ring with DWT stamps (trace.c), overrides the Event Recorder hooks */
+#include "trace_hooks.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
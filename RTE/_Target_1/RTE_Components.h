@@ -22,6 +22,8 @@
 #define RTE_RTOS_FreeRTOS_CORE          /* RTOS FreeRTOS Core */
 /* ARM.FreeRTOS::RTOS:Heap:Heap_4:10.5.1 */
 #define RTE_RTOS_FreeRTOS_HEAP_4        /* RTOS FreeRTOS Heap 4 */
+/* ARM.FreeRTOS::RTOS:Timers:10.5.1 */
+#define RTE_RTOS_FreeRTOS_TIMERS        /* RTOS FreeRTOS Timers */
 
 
 #endif /* RTE_COMPONENTS_H */
@@ -0,0 +1,117 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "queue.h"
+#include "semphr.h"
+#include "tm4c123gh6pm.h"
+#include "gpio_fast.h"
+#include "cycles.h"
+#include "bench.h"
+#include "eventlog.h"
+#include "spsc.h"
+#include "window.h"
+#include "config.h"
+
+volatile struct BenchResults BenchResults;
+
+static volatile uint32_t sink;
+
+// Scan as CheckButtons used to: one volatile load per switch bit
+static uint32_t scanPerBit(void){
+	uint32_t word = 0;
+	word |= ((GPIO_PORTB_DATA_R & (1U << 4)) >> 4) << 0;
+	word |= ((GPIO_PORTD_DATA_R & (1U << 2)) >> 2) << 1;
+	word |= ((GPIO_PORTC_DATA_R & (1U << 5)) >> 5) << 2;
+	word |= ((GPIO_PORTC_DATA_R & (1U << 6)) >> 6) << 3;
+	word |= ((GPIO_PORTD_DATA_R & (1U << 3)) >> 3) << 4;
+	word |= ((GPIO_PORTB_DATA_R & (1U << 0)) >> 0) << 5;
+	word |= ((GPIO_PORTB_DATA_R & (1U << 1)) >> 1) << 6;
+	return word;
+}
+
+static uint32_t scanMasked(void){
+	return gpioReadB() | (gpioReadC() << 8) | (gpioReadD() << 16);
+}
+
+static uint32_t logRecord(void){
+	eventLogRecord(LOG_PIN_JAM, 1);
+	return 0;
+}
+
+SPSC_DEFINE(benchRing, uint32_t, 16);
+static QueueHandle_t benchQueue;
+
+static uint32_t ringRoundTrip(void){
+	uint32_t in = 1, out[4];
+	spscPush(&benchRing, &in);
+	spscPush(&benchRing, &in);
+	spscPush(&benchRing, &in);
+	spscPush(&benchRing, &in);
+	return spscPopBatch(&benchRing, out, 4);
+}
+
+static uint32_t queueRoundTrip(void){
+	uint32_t in = 1, out;
+	BaseType_t woken = pdFALSE;
+	for(int i = 0; i < 4; i++){
+		xQueueSendFromISR(benchQueue, &in, &woken);
+	}
+	for(int i = 0; i < 4; i++){
+		xQueueReceive(benchQueue, &out, 0);
+	}
+	return out;
+}
+
+static SemaphoreHandle_t benchMutex;
+static struct Window benchWindow;
+
+static uint32_t seqlockRead(void){
+	struct Window w;
+	windowRead(&w);
+	return w.autoMode;
+}
+
+static uint32_t mutexRead(void){
+	struct Window w;
+	xSemaphoreTake(benchMutex, portMAX_DELAY);
+	w = benchWindow;
+	xSemaphoreGive(benchMutex);
+	return w.autoMode;
+}
+
+// Full boot-time load: scan every slot, verify, copy the newest
+static uint32_t loadConfig(void){
+	configLoad();
+	return Config.scanPeriodMs;
+}
+
+static uint32_t measure(uint32_t (*scan)(void)){
+	uint32_t best = UINT32_MAX;
+	for(int i = 0; i < BENCH_RUNS; i++){
+		uint32_t start = cyclesNow();
+		sink = scan();
+		uint32_t elapsed = cyclesNow() - start;
+		if (elapsed < best){
+			best = elapsed;
+		}
+	}
+	return best;
+}
+
+void runBenchmarks(void){
+	cyclesEnable();
+	BenchResults.scanPerBit = measure(scanPerBit);
+	BenchResults.scanMasked = measure(scanMasked);
+	BenchResults.logRecord = measure(logRecord);
+	eventLogInit();
+	
+	benchQueue = xQueueCreate(16, sizeof(uint32_t));
+	BenchResults.ringRoundTrip = measure(ringRoundTrip);
+	BenchResults.queueRoundTrip = measure(queueRoundTrip);
+	
+	benchMutex = xSemaphoreCreateMutex();
+	BenchResults.seqlockRead = measure(seqlockRead);
+	BenchResults.mutexRead = measure(mutexRead);
+	
+	BenchResults.configLoad = measure(loadConfig);
+}
@@ -0,0 +1,24 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#define BENCH_RUNS 64
+
+// Results are left in BenchResults for the debugger watch window
+struct BenchResults {
+	uint32_t scanPerBit;
+	uint32_t scanMasked;
+	uint32_t logRecord;
+	uint32_t ringRoundTrip;
+	uint32_t queueRoundTrip;
+	uint32_t seqlockRead;
+	uint32_t mutexRead;
+	uint32_t configLoad;
+};
+
+extern volatile struct BenchResults BenchResults;
+
+void runBenchmarks(void);
+
+#endif
@@ -0,0 +1,27 @@
+#include <stdint.h>
+#include "cycles.h"
+#include "boot.h"
+
+extern uint32_t SystemCoreClock;
+
+struct BootProfile BootProfile __attribute__((section(".ARM.__at_0x20007F80")));
+
+// Runs first thing in SystemInit: no initialised data may be touched here
+void bootProfileReset(void){
+	cyclesInit();
+	BootProfile.magic = BOOT_MAGIC;
+	for(int i = 0; i < BOOT_STAGES; i++){
+		BootProfile.cycles[i] = 0;
+	}
+	BootProfile.responsiveUs = 0;
+}
+
+void bootStamp(uint32_t stage){
+	if (BootProfile.cycles[stage] != 0){
+		return;
+	}
+	BootProfile.cycles[stage] = cyclesNow();
+	if (stage == BOOT_FIRST_INPUT){
+		BootProfile.responsiveUs = BootProfile.cycles[stage] / (SystemCoreClock / 1000000);
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+enum BootStage {
+	BOOT_RESET,
+	BOOT_SYSTEMINIT,
+	BOOT_MAIN,
+	BOOT_CONFIG,
+	BOOT_INIT,
+	BOOT_SCHEDULER,
+	BOOT_FIRST_INPUT,
+	BOOT_STAGES
+};
+
+// Lives in the NoInit IRAM2 region next to the watchdog's retained state,
+// SystemInit stamps into it before the C library clears .bss
+#define BOOT_PROFILE_ADDR 0x20007F80
+#define BOOT_MAGIC 0x544F4F42UL
+
+// Cycles are DWT counts from the top of SystemInit. Up to BOOT_MAIN they
+// run at 16 MHz and during clockInit's PLL lock at CLOCK_LOW_HZ, so
+// responsiveUs, converted at CLOCK_FULL_HZ, under-reports by about
+// ClockStats.lockUsLast.
+struct BootProfile {
+	uint32_t magic;
+	uint32_t cycles[BOOT_STAGES];
+	uint32_t responsiveUs;
+};
+
+extern struct BootProfile BootProfile;
+
+void bootProfileReset(void);
+void bootStamp(uint32_t stage);
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "tm4c123gh6pm.h"
+#include "cycles.h"
+#include "eventlog.h"
+#include "trace.h"
+#include "clock.h"
+
+// port.c; recomputes the SysTick reload and the tickless idle limits
+// from configCPU_CLOCK_HZ
+void vPortSetupTimerInterrupt(void);
+
+// 400 MHz / (2 * 2 + 1): SYSDIV2 = 2, SYSDIV2LSB clear
+#define FULL_SYSDIV2 (2U << SYSCTL_RCC2_SYSDIV2_S)
+#define LOW_SYSDIV2 ((CLOCK_LOW_DIV - 1U) << SYSCTL_RCC2_SYSDIV2_S)
+#define RCC2_DIVIDERS (SYSCTL_RCC2_DIV400 | SYSCTL_RCC2_SYSDIV2_M | SYSCTL_RCC2_SYSDIV2LSB)
+
+volatile struct ClockStats ClockStats;
+
+static ClockFn Clients[CLOCK_CLIENTS];
+static enum ClockPoint Point;
+
+static uint32_t usSince(uint32_t start){
+	return cyclesToUs(cyclesNow() - start);
+}
+
+// Every client, then SysTick once the kernel owns it
+static void rederive(void){
+	for(uint32_t i = 0; i < CLOCK_CLIENTS; i++){
+		if (Clients[i] != NULL){
+			Clients[i]();
+		}
+	}
+	if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED){
+		vPortSetupTimerInterrupt();
+	}
+}
+
+// Takes over from SystemInit's fixed RCC setup: drops to CLOCK_LOW on
+// RCC2, then comes up to CLOCK_FULL the same way every later switch does.
+// Called first thing in main, before any peripheral loads a count.
+void clockInit(void){
+	SYSCTL_RCC_R = (SYSCTL_RCC_R & ~(SYSCTL_RCC_XTAL_M | SYSCTL_RCC_MOSCDIS)) | SYSCTL_RCC_XTAL_16MHZ | SYSCTL_RCC_USESYSDIV;
+	SYSCTL_RCC2_R = (SYSCTL_RCC2_R & SYSCTL_RCC2_USBPWRDN) | SYSCTL_RCC2_USERCC2 | SYSCTL_RCC2_BYPASS2 |
+	                SYSCTL_RCC2_OSCSRC2_IO | LOW_SYSDIV2 | SYSCTL_RCC2_PWRDN2;
+	SystemCoreClock = CLOCK_LOW_HZ;
+	Point = CLOCK_LOW;
+	clockSelect(CLOCK_FULL);
+}
+
+void clockSetup(enum ClockClient id, ClockFn fn){
+	Clients[id] = fn;
+}
+
+// Task context (or main before the scheduler). Going up, the PLL is
+// powered and locked while the core keeps running at the old frequency
+// with the scheduler suspended; only the bypass flip and the
+// re-derivation sit in a critical section. Going down needs no wait.
+void clockSelect(enum ClockPoint point){
+	bool running = xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+	if (running){
+		vTaskSuspendAll();
+	}
+	if (point == Point){
+		if (running){
+			xTaskResumeAll();
+		}
+		return;
+	}
+	
+	uint32_t start = cyclesNow();
+	if (point == CLOCK_FULL){
+		// Same CLOCK_LOW_HZ from the crystal while the PLL locks
+		SYSCTL_RCC2_R = (SYSCTL_RCC2_R & ~(SYSCTL_RCC2_OSCSRC2_M | SYSCTL_RCC2_PWRDN2)) | SYSCTL_RCC2_OSCSRC2_MO;
+		while(!(SYSCTL_PLLSTAT_R & SYSCTL_PLLSTAT_LOCK));
+		ClockStats.lockUsLast = usSince(start);
+		if (ClockStats.lockUsLast > ClockStats.lockUsMax){
+			ClockStats.lockUsMax = ClockStats.lockUsLast;
+		}
+	}
+	
+	taskENTER_CRITICAL();
+	if (point == CLOCK_FULL){
+		SYSCTL_RCC2_R = (SYSCTL_RCC2_R & ~RCC2_DIVIDERS) | SYSCTL_RCC2_DIV400 | FULL_SYSDIV2;
+		SYSCTL_RCC2_R &= ~SYSCTL_RCC2_BYPASS2;
+		SystemCoreClock = CLOCK_FULL_HZ;
+	}
+	else {
+		SYSCTL_RCC2_R |= SYSCTL_RCC2_BYPASS2;
+		SYSCTL_RCC2_R = (SYSCTL_RCC2_R & ~(RCC2_DIVIDERS | SYSCTL_RCC2_OSCSRC2_M)) | SYSCTL_RCC2_OSCSRC2_IO | LOW_SYSDIV2 | SYSCTL_RCC2_PWRDN2;
+		SystemCoreClock = CLOCK_LOW_HZ;
+	}
+	start = cyclesNow();
+	rederive();
+	Point = point;
+	// Cycle stamps change rate here; the logs carry the switch so their
+	// readers can convert either side
+	traceClock(point == CLOCK_FULL ? CLOCK_LOW_HZ : CLOCK_FULL_HZ, SystemCoreClock);
+	eventLogRecord(LOG_PIN_CLOCK, point == CLOCK_FULL);
+	taskEXIT_CRITICAL();
+	
+	ClockStats.point = point;
+	ClockStats.switches++;
+	ClockStats.switchUsLast = usSince(start);
+	if (ClockStats.switchUsLast > ClockStats.switchUsMax){
+		ClockStats.switchUsMax = ClockStats.switchUsLast;
+	}
+	if (running){
+		xTaskResumeAll();
+	}
+}
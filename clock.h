@@ -0,0 +1,52 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+// Two operating points. The motor runs at CLOCK_FULL; once it has been
+// off for CLOCK_IDLE_MS the motion task drops to CLOCK_LOW. A start from
+// CLOCK_LOW (a button, a jam reversal) drives the motor first and then
+// comes up, so the motor runs for the PLL lock time at CLOCK_LOW with the
+// PWM re-derived and current sampling not yet running. The main
+// oscillator stays up at CLOCK_LOW so the way back is only the lock.
+enum ClockPoint {
+	CLOCK_LOW,      // PIOSC / CLOCK_LOW_DIV, PLL powered down
+	CLOCK_FULL,     // 16 MHz crystal, 400 MHz PLL / 5
+	CLOCK_POINTS
+};
+
+#define CLOCK_FULL_HZ 80000000UL
+#define CLOCK_PIOSC_HZ 16000000UL
+#define CLOCK_LOW_DIV 4
+#define CLOCK_LOW_HZ (CLOCK_PIOSC_HZ / CLOCK_LOW_DIV)
+#define CLOCK_IDLE_MS 500
+
+// Everything that loads a count derived from SystemCoreClock. The
+// callbacks run inside the switch's critical section with the new
+// SystemCoreClock in place and must only rewrite registers.
+enum ClockClient {
+	CLOCK_PWM,
+	CLOCK_WATCHDOG,
+	CLOCK_PROFILE,
+	CLOCK_CURRENT,
+	CLOCK_CLIENTS
+};
+
+typedef void (*ClockFn)(void);
+
+struct ClockStats {
+	uint32_t point;
+	uint32_t switches;
+	uint32_t lockUsLast;    // PLL power-up to lock, scheduler suspended
+	uint32_t lockUsMax;
+	uint32_t switchUsLast;  // critical section: source change and re-derivation
+	uint32_t switchUsMax;
+};
+
+extern volatile struct ClockStats ClockStats;
+
+void clockInit(void);
+void clockSetup(enum ClockClient id, ClockFn fn);
+void clockSelect(enum ClockPoint point);
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "gpio_fast.h"
+#include "inputs.h"
+#include "limits.h"
+#include "closure.h"
+
+// Internal position keeps three extra decimal digits so 10 ms steps of a
+// multi-second travel do not truncate to zero
+#define SCALE 1000
+#define MAX_STEP_MS 1000
+
+// Change needed before a refined travel time is worth an EEPROM write
+#define LEARN_STORE_PCT 2
+
+volatile struct ClosureStats ClosureStats;
+
+static struct ClosureProfile Profile = CLOSURE_PROFILE_DEFAULT;
+static struct TravelTimes Travel = {TRAVEL_UP_MS, TRAVEL_DOWN_MS};
+static struct TravelTimes Stored;
+static bool Learned[2];
+static bool Dirty;
+static volatile uint32_t Position;
+static volatile bool Referenced;
+static volatile bool Pinch = true;
+static volatile uint32_t JamThreshold;
+static TickType_t LastStep;
+static uint32_t LastDir = MOTOR_OFF;
+static uint32_t LastLimits;
+
+// Stroke being timed: starts when the motor leaves one limit switch and
+// only counts if it reaches the other one without stopping or reversing
+static uint32_t StrokeDir = MOTOR_OFF;
+static uint32_t StrokeWork;
+// Travel the estimate wanted past the end it is clamped to
+static uint32_t Overshoot;
+
+void closureInit(void){
+	Position = POSITION_OPEN * SCALE;
+	Referenced = false;
+	JamThreshold = Profile.jamPinchMa;
+}
+
+void closureConfigure(const struct ClosureProfile *profile){
+	Profile = *profile;
+}
+
+static uint32_t advance(uint32_t ms, uint32_t travelMs, uint32_t duty){
+	return (ms * duty * SCALE) / travelMs;
+}
+
+uint32_t closurePosition(void){
+	return Position / SCALE;
+}
+
+void closureSetTravel(const struct TravelTimes *travel){
+	Travel = *travel;
+	Stored = *travel;
+	Learned[0] = true;
+	Learned[1] = true;
+}
+
+bool closureLearned(void){
+	return Learned[0] && Learned[1];
+}
+
+// Position can be trusted for a stop in mid travel
+bool closureCalibrated(void){
+	return Referenced && closureLearned();
+}
+
+// Returns the travel times once after they changed enough to store
+bool closureTakeLearned(struct TravelTimes *out){
+	if (!Dirty || !closureLearned()){
+		return false;
+	}
+	Dirty = false;
+	Stored = Travel;
+	*out = Travel;
+	return true;
+}
+
+static bool differs(uint32_t a, uint32_t b){
+	uint32_t d = a > b ? a - b : b - a;
+	return d * 100 > b * LEARN_STORE_PCT;
+}
+
+// The first clean stroke each way sets the travel time, later ones are
+// averaged in with a weight of 1/4
+static void learn(uint32_t dir, uint32_t ms){
+	if (ms < TRAVEL_MIN_MS || ms > TRAVEL_MAX_MS){
+		return;
+	}
+	uint32_t i = dir == MOTOR_UP ? 0 : 1;
+	uint32_t *travel = i == 0 ? &Travel.upMs : &Travel.downMs;
+	uint32_t stored = i == 0 ? Stored.upMs : Stored.downMs;
+	*travel = Learned[i] ? (3 * *travel + ms) / 4 : ms;
+	Learned[i] = true;
+	if (differs(*travel, stored)){
+		Dirty = true;
+	}
+}
+
+// Until a limit switch has been seen and both travel times are known the
+// position is a guess, so the whole closing stroke is treated as pinch zone.
+static bool inPinchZone(uint32_t dir){
+	return dir == MOTOR_UP && (!Referenced || !closureLearned() || closurePosition() >= Profile.pinchStart);
+}
+
+uint32_t closureDutyFor(uint32_t dir){
+	return inPinchZone(dir) ? Profile.dutyPinch : Profile.dutyFull;
+}
+
+static void arrive(uint32_t dir, uint32_t target){
+	uint32_t pos = closurePosition();
+	uint32_t error = pos > target ? pos - target : target - pos;
+	if (Overshoot != 0){
+		error = Overshoot / SCALE;
+		Overshoot = 0;
+	}
+	ClosureStats.strokes++;
+	ClosureStats.lastError = error;
+	if (Referenced && closureLearned() && error > ClosureStats.maxError){
+		ClosureStats.maxError = error;
+	}
+	if (StrokeDir == dir){
+		learn(dir, StrokeWork / 1000);
+	}
+	StrokeDir = MOTOR_OFF;
+}
+
+// Integrates travel while the motor runs and re-references at the stops.
+// duty is what was applied since the last step, after any derating or
+// deceleration. Travel is integrated as duty-weighted time, so strokes that
+// pass through the slow pinch zone still time out to the full-duty equivalent.
+void closureStep(uint32_t dir, uint32_t duty, TickType_t now){
+	uint32_t ms = (now - LastStep) * portTICK_PERIOD_MS;
+	LastStep = now;
+	// The limit usually stops the motor before this step sees the switch
+	uint32_t moving = LastDir != MOTOR_OFF ? LastDir : dir;
+	if (dir != LastDir || ms > MAX_STEP_MS){
+		ms = 0;
+	}
+	if (dir != LastDir){
+		Overshoot = 0;
+	}
+	LastDir = dir;
+	
+	if (dir == MOTOR_UP){
+		uint32_t pos = Position + advance(ms, Travel.upMs, duty);
+		if (pos > POSITION_CLOSED * SCALE){
+			Overshoot += pos - POSITION_CLOSED * SCALE;
+			pos = POSITION_CLOSED * SCALE;
+		}
+		Position = pos;
+	}
+	else if (dir == MOTOR_DOWN){
+		uint32_t step = advance(ms, Travel.downMs, duty);
+		if (step > Position){
+			Overshoot += step - Position;
+			step = Position;
+		}
+		Position -= step;
+	}
+	
+	uint32_t limits = limitsState();
+	uint32_t reached = limits & ~LastLimits;
+	LastLimits = limits;
+	if (dir != MOTOR_OFF && dir == StrokeDir){
+		StrokeWork += ms * duty;
+	}
+	if ((reached & IN_LIMIT_CLOSED) && moving == MOTOR_UP){
+		arrive(MOTOR_UP, POSITION_CLOSED);
+	}
+	else if ((reached & IN_LIMIT_OPENED) && moving == MOTOR_DOWN){
+		arrive(MOTOR_DOWN, POSITION_OPEN);
+	}
+	if (dir != MOTOR_OFF && (limits & (dir == MOTOR_UP ? IN_LIMIT_OPENED : IN_LIMIT_CLOSED))){
+		StrokeDir = dir;
+		StrokeWork = 0;
+	}
+	else if (dir != StrokeDir){
+		StrokeDir = MOTOR_OFF;
+	}
+	
+	if (limits & IN_LIMIT_CLOSED){
+		Position = POSITION_CLOSED * SCALE;
+		Referenced = true;
+	}
+	else if (limits & IN_LIMIT_OPENED){
+		Position = POSITION_OPEN * SCALE;
+		Referenced = true;
+	}
+	
+	Pinch = inPinchZone(dir);
+	JamThreshold = Pinch ? Profile.jamPinchMa : Profile.jamFullMa;
+}
+
+uint32_t closureJamThreshold(void){
+	return JamThreshold;
+}
+
+bool closureInPinchZone(void){
+	return Pinch;
+}
@@ -0,0 +1,60 @@
+#ifndef CLOSURE_H
+#define CLOSURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+
+// Position is in per-mille of travel: 0 fully open, 1000 fully closed
+#define POSITION_OPEN   0
+#define POSITION_CLOSED 1000
+
+// Nominal full-duty travel times until they are measured on the car.
+// A learned time outside the sane range is discarded.
+#define TRAVEL_UP_MS   4000
+#define TRAVEL_DOWN_MS 3500
+#define TRAVEL_MIN_MS  1000
+#define TRAVEL_MAX_MS  15000
+
+#define PROFILE_PERIOD_MS 10
+
+// Duty in per-mille, jam thresholds in mA of motor current
+struct ClosureProfile {
+	uint32_t pinchStart;
+	uint32_t dutyFull;
+	uint32_t dutyPinch;
+	uint32_t jamFullMa;
+	uint32_t jamPinchMa;
+};
+
+#define CLOSURE_PROFILE_DEFAULT {900, 1000, 400, 4000, 1500}
+
+// Full-duty equivalent switch-to-switch travel
+struct TravelTimes {
+	uint32_t upMs;
+	uint32_t downMs;
+};
+
+// Estimator error is the distance the estimate was off, in per-mille of
+// travel, when a limit switch closed at the end of a stroke
+struct ClosureStats {
+	uint32_t strokes;
+	uint32_t lastError;
+	uint32_t maxError;
+};
+
+extern volatile struct ClosureStats ClosureStats;
+
+void closureInit(void);
+void closureConfigure(const struct ClosureProfile *profile);
+void closureStep(uint32_t dir, uint32_t duty, TickType_t now);
+void closureSetTravel(const struct TravelTimes *travel);
+bool closureTakeLearned(struct TravelTimes *out);
+bool closureLearned(void);
+bool closureCalibrated(void);
+uint32_t closureDutyFor(uint32_t dir);
+uint32_t closurePosition(void);
+uint32_t closureJamThreshold(void);
+bool closureInPinchZone(void);
+
+#endif
@@ -0,0 +1,134 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "motion.h"
+#include "nvm.h"
+#include "config.h"
+
+#define HEADER_WORDS 4
+#define SLOT_WORDS (CONFIG_SLOT_BYTES / sizeof(uint32_t))
+
+_Static_assert(HEADER_WORDS + sizeof(struct Config) / sizeof(uint32_t) + 1 <= SLOT_WORDS, "Config outgrew its EEPROM slot");
+_Static_assert(CONFIG_SLOTS * CONFIG_SLOT_BYTES <= NVM_CONFIG_END, "Config slots overlap the next EEPROM region");
+
+// Slot layout: magic, version, seq, payload bytes, payload words, CRC-32
+// over everything before it
+struct ConfigRecord {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t seq;
+	uint32_t size;
+	uint32_t words[SLOT_WORDS - HEADER_WORDS];
+};
+
+struct Config Config;
+volatile struct ConfigStats ConfigStats;
+
+static const struct Config Defaults = {
+	CONFIG_SCAN_PERIOD_MS,
+	CONFIG_JAM_REVERSE_MS,
+	MOTION_TIMEOUT_MS,
+	CLOSURE_PROFILE_DEFAULT,
+	PRESET_DEFAULTS,
+	{0, 0},
+	GESTURE_DEFAULTS
+};
+
+static struct ConfigRecord Record;
+static uint32_t Slot = CONFIG_SLOTS - 1;
+static uint32_t Seq;
+
+// Nibble-table CRC-32 (IEEE), 64 bytes of table instead of 1 KB
+static uint32_t crc32(const uint32_t *words, uint32_t count){
+	static const uint32_t table[16] = {
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+	};
+	uint32_t crc = 0xFFFFFFFFUL;
+	for(uint32_t i = 0; i < count; i++){
+		uint32_t w = words[i];
+		for(int b = 0; b < 8; b++){
+			crc = (crc >> 4) ^ table[(crc ^ w) & 0x0F];
+			w >>= 4;
+		}
+	}
+	return ~crc;
+}
+
+static uint32_t slotAddr(uint32_t slot){
+	return NVM_CONFIG_ADDR + slot * CONFIG_SLOT_BYTES;
+}
+
+static uint32_t payloadWords(uint32_t size){
+	return (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+}
+
+// Header first, so erased and foreign slots cost a four word read
+static bool readSlot(uint32_t slot){
+	nvmRead((uint32_t *)&Record, slotAddr(slot), HEADER_WORDS * sizeof(uint32_t));
+	if (Record.magic != CONFIG_MAGIC || Record.size > sizeof(Record.words) - sizeof(uint32_t)){
+		return false;
+	}
+	uint32_t words = payloadWords(Record.size);
+	nvmRead(Record.words, slotAddr(slot) + HEADER_WORDS * sizeof(uint32_t), (words + 1) * sizeof(uint32_t));
+	return Record.words[words] == crc32((const uint32_t *)&Record, HEADER_WORDS + words);
+}
+
+void configLoad(void){
+	int32_t best = -1;
+	uint32_t bestSeq = 0;
+	ConfigStats.badSlots = 0;
+	for(uint32_t i = 0; i < CONFIG_SLOTS; i++){
+		if (!readSlot(i)){
+			if (Record.magic == CONFIG_MAGIC){
+				ConfigStats.badSlots++;
+			}
+			continue;
+		}
+		if (best < 0 || (int32_t)(Record.seq - bestSeq) > 0){
+			best = i;
+			bestSeq = Record.seq;
+		}
+	}
+	
+	Config = Defaults;
+	ConfigStats.source = CONFIG_DEFAULTS;
+	ConfigStats.version = CONFIG_VERSION;
+	if (best >= 0){
+		readSlot(best);
+		uint32_t size = Record.size < sizeof(Config) ? Record.size : sizeof(Config);
+		memcpy(&Config, Record.words, size);
+		Slot = best;
+		Seq = Record.seq;
+		ConfigStats.source = CONFIG_EEPROM;
+		ConfigStats.version = Record.version;
+	}
+	ConfigStats.slot = Slot;
+	ConfigStats.seq = Seq;
+}
+
+// Each save goes to the slot after the current one, so writes spread over
+// all slots and an interrupted save leaves the previous record in charge.
+// Blocks for the EEPROM program time, call from task context only.
+bool configSave(void){
+	uint32_t slot = (Slot + 1) % CONFIG_SLOTS;
+	uint32_t words = payloadWords(sizeof(Config));
+	Record.magic = CONFIG_MAGIC;
+	Record.version = CONFIG_VERSION;
+	Record.seq = Seq + 1;
+	Record.size = sizeof(Config);
+	memcpy(Record.words, &Config, sizeof(Config));
+	Record.words[words] = crc32((const uint32_t *)&Record, HEADER_WORDS + words);
+	
+	if (nvmWrite((const uint32_t *)&Record, slotAddr(slot), (HEADER_WORDS + words + 1) * sizeof(uint32_t)) != 0){
+		ConfigStats.writeErrors++;
+		return false;
+	}
+	Slot = slot;
+	Seq++;
+	ConfigStats.slot = Slot;
+	ConfigStats.seq = Seq;
+	ConfigStats.saves++;
+	return true;
+}
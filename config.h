@@ -0,0 +1,57 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "closure.h"
+#include "preset.h"
+#include "gesture.h"
+
+// Defaults for tunables that have no module of their own
+#define CONFIG_SCAN_PERIOD_MS 5
+#define CONFIG_JAM_REVERSE_MS 500
+
+// Runtime tunables. Loaded once at boot and read in place, so a hot path
+// reads Config.field like any other global. Fields are only ever appended:
+// bump CONFIG_VERSION with each addition and an older record keeps its
+// prefix while the new fields take their defaults.
+struct Config {
+	uint32_t scanPeriodMs;
+	uint32_t jamReverseMs;
+	uint32_t motionTimeoutMs;
+	struct ClosureProfile profile;
+	uint32_t presets[PRESETS];
+	struct TravelTimes travel;   // 0 until learned
+	struct GestureConfig gestures[GESTURE_INPUTS];
+};
+
+#define CONFIG_VERSION 2
+
+// Records rotate through CONFIG_SLOTS slots at the bottom of the EEPROM,
+// the valid one with the highest sequence number wins
+#define CONFIG_MAGIC      0x47464E43UL
+#define CONFIG_SLOT_BYTES 128
+#define CONFIG_SLOTS      12
+
+enum ConfigSource {
+	CONFIG_DEFAULTS,
+	CONFIG_EEPROM
+};
+
+struct ConfigStats {
+	uint32_t source;
+	uint32_t version;
+	uint32_t slot;
+	uint32_t seq;
+	uint32_t saves;
+	uint32_t badSlots;
+	uint32_t writeErrors;
+};
+
+extern struct Config Config;
+extern volatile struct ConfigStats ConfigStats;
+
+void configLoad(void);
+bool configSave(void);
+
+#endif
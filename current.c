@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "current.h"
+#include "gpio_fast.h"
+#include "spsc.h"
+#include "clock.h"
+
+extern uint32_t SystemCoreClock;
+
+// Filled by the SS3 interrupt, drained by every motion task profile step,
+// so it holds at most one LIVENESS_PERIOD_MS wait (motion.c) of samples.
+// A full ring drops the newest sample.
+SPSC_DEFINE(CurrentSamples, uint16_t, 64);
+
+volatile struct CurrentStats CurrentStats;
+
+static uint32_t LastRaw;
+
+// Timer 2A triggers SS3 at CURRENT_SAMPLE_HZ; also runs on every clock
+// switch and stops sampling at CLOCK_LOW, where the motor only runs until
+// the clock has come up after a start
+static void sampleRederive(void){
+	TIMER2_CTL_R = 0;
+	TIMER2_TAILR_R = SystemCoreClock / CURRENT_SAMPLE_HZ - 1;
+	if (SystemCoreClock == CLOCK_FULL_HZ){
+		TIMER2_CTL_R = TIMER_CTL_TAOTE | TIMER_CTL_TAEN;
+	}
+}
+
+// SS3 takes one timer-triggered sample, averaged 64x in hardware so a
+// conversion spans a little more than one PWM period.
+void currentInit(void){
+	SYSCTL_RCGCADC_R |= SYSCTL_RCGCADC_R0;
+	SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+	while(!(SYSCTL_PRADC_R & SYSCTL_PRADC_R0));
+	while(!(SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R2));
+	
+	GPIO_PORTE_AFSEL_R |= PE_CURRENT_SENSE;
+	GPIO_PORTE_DEN_R &= ~PE_CURRENT_SENSE;
+	GPIO_PORTE_AMSEL_R |= PE_CURRENT_SENSE;
+	
+	// PIOSC clocks the ADC at the same 16 MHz as PLL / 25, and keeps
+	// running at CLOCK_LOW (clock.h) with the PLL powered down
+	ADC0_CC_R = ADC_CC_CS_PIOSC;
+	ADC0_ACTSS_R &= ~ADC_ACTSS_ASEN3;
+	ADC0_EMUX_R = (ADC0_EMUX_R & ~ADC_EMUX_EM3_M) | ADC_EMUX_EM3_TIMER;
+	ADC0_SSMUX3_R = 0;
+	ADC0_SSCTL3_R = ADC_SSCTL3_IE0 | ADC_SSCTL3_END0;
+	ADC0_SAC_R = ADC_SAC_AVG_64X;
+	ADC0_ISC_R = ADC_ISC_IN3;
+	ADC0_IM_R |= ADC_IM_MASK3;
+	ADC0_ACTSS_R |= ADC_ACTSS_ASEN3;
+	
+	TIMER2_CTL_R = 0;
+	TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;
+	TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+	sampleRederive();
+	clockSetup(CLOCK_CURRENT, sampleRederive);
+}
+
+// Registered by init() through isrRegister(); touches no kernel object
+void currentInterrupt(void){
+	ADC0_ISC_R = ADC_ISC_IN3;
+	uint16_t raw = (uint16_t)(ADC0_SSFIFO3_R & ADC_SSFIFO3_DATA_M);
+	if (!spscPush(&CurrentSamples, &raw)){
+		CurrentStats.dropped++;
+	}
+}
+
+// Averages everything converted since the last call, which also drains
+// the ring while the motor is off (duty 0). The shunt only carries current
+// during the on-time, so the average is divided by the duty to get the
+// motor current. With nothing new the previous average stands.
+uint32_t currentReadMa(uint32_t duty){
+	uint16_t batch[16];
+	uint32_t sum = 0;
+	uint32_t count = 0;
+	uint32_t n;
+	while((n = spscPopBatch(&CurrentSamples, batch, 16)) != 0){
+		for(uint32_t i = 0; i < n; i++){
+			sum += batch[i];
+		}
+		count += n;
+	}
+	if (count != 0){
+		LastRaw = sum / count;
+		CurrentStats.samples += count;
+		if (count > CurrentStats.batchMax){
+			CurrentStats.batchMax = count;
+		}
+	}
+	
+	if (duty == 0){
+		return 0;
+	}
+	return LastRaw * CURRENT_UA_PER_COUNT / duty;
+}
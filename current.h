@@ -0,0 +1,25 @@
+#ifndef CURRENT_H
+#define CURRENT_H
+
+#include <stdint.h>
+
+// Low-side shunt on PE3 (AIN0): 10 mOhm with a gain of 20 gives 0.2 V/A,
+// one count of the 12-bit ADC at 3.3 V is 4029 uA of supply current.
+#define CURRENT_UA_PER_COUNT 4029
+
+// Ten conversions per PROFILE_PERIOD_MS step
+#define CURRENT_SAMPLE_HZ 1000
+
+struct CurrentStats {
+	uint32_t samples;
+	uint32_t dropped;   // ring full, the profile step fell behind
+	uint32_t batchMax;
+};
+
+extern volatile struct CurrentStats CurrentStats;
+
+void currentInit(void);
+void currentInterrupt(void);
+uint32_t currentReadMa(uint32_t duty);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdint.h>
+
+#define DEMCR_R      (*((volatile uint32_t *)0xE000EDFC))
+#define DWT_CTRL_R   (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R (*((volatile uint32_t *)0xE0001004))
+
+#define DEMCR_TRCENA      0x01000000U
+#define DWT_CTRL_CYCCNTENA 0x00000001U
+
+#ifdef SIMULATOR
+// Host build: the simulator counts cycles at the modelled SystemCoreClock
+#include "sim_hw.h"
+
+static inline void cyclesEnable(void){
+}
+
+static inline void cyclesInit(void){
+	simCyclesReset();
+}
+
+static inline uint32_t cyclesNow(void){
+	return simCycles();
+}
+#else
+// Starts the counter without touching its value; safe for any module
+// that stamps with cyclesNow()
+static inline void cyclesEnable(void){
+	DEMCR_R |= DEMCR_TRCENA;
+	DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+}
+
+// Zeroes the counter as well, so cycle 0 is reset. Only bootProfileReset
+// calls this; the boot stages are stamped against that origin.
+static inline void cyclesInit(void){
+	DEMCR_R |= DEMCR_TRCENA;
+	DWT_CYCCNT_R = 0;
+	DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+}
+
+static inline uint32_t cyclesNow(void){
+	return DWT_CYCCNT_R;
+}
+#endif
+
+extern uint32_t SystemCoreClock;
+
+// A cycle count is only meaningful with the clock it ran at (clock.h
+// switches between two), so stats that outlive a switch are kept in us
+static inline uint32_t cyclesToUs(uint32_t cycles){
+	return cycles / (SystemCoreClock / 1000000U);
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "cycles.h"
+#include "eventlog.h"
+#include "nvm.h"
+
+struct EventLog EventLog;
+
+// Tick and clock at the last record, for gaps longer than the stamp wraps
+static TickType_t LastTick;
+static uint32_t LastHz;
+
+static void push(uint32_t record){
+	EventLog.records[EventLog.head & (LOG_SIZE - 1)] = record;
+	EventLog.head++;
+}
+
+void eventLogInit(void){
+	cyclesEnable();
+	EventLog.magic = LOG_MAGIC;
+	EventLog.head = 0;
+	EventLog.dropped = 0;
+	EventLog.lastStamp = cyclesNow() >> LOG_TIME_SHIFT;
+	LastTick = xTaskGetTickCountFromISR();
+	LastHz = SystemCoreClock;
+}
+
+// Whole stamp wraps in a gap of ms ticks whose stamp delta came out as
+// delta: the count of wraps that brings delta nearest the tick time. Every
+// clock switch is logged, so the gap ran at the clock of the last record.
+static uint32_t wrapsIn(uint32_t delta, TickType_t ms){
+	uint64_t expected = ((uint64_t)ms * (LastHz / 1000)) >> LOG_TIME_SHIFT;
+	if (expected <= delta){
+		return 0;
+	}
+	return (uint32_t)((expected - delta + (1ULL << (LOG_STAMP_BITS - 1))) >> LOG_STAMP_BITS);
+}
+
+// Safe from tasks and ISRs; at most two stores into the ring, no loops
+void eventLogRecord(uint32_t pin, uint32_t value){
+	UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	
+	uint32_t stamp = cyclesNow() >> LOG_TIME_SHIFT;
+	TickType_t tick = xTaskGetTickCountFromISR();
+	uint32_t delta = (stamp - EventLog.lastStamp) & (UINT32_MAX >> LOG_TIME_SHIFT);
+	uint64_t gap = delta | ((uint64_t)wrapsIn(delta, tick - LastTick) << LOG_STAMP_BITS);
+	EventLog.lastStamp = stamp;
+	LastTick = tick;
+	LastHz = SystemCoreClock;
+	
+	if (gap > LOG_DELTA_MAX){
+		uint64_t high = gap >> LOG_DELTA_BITS;
+		push(LOG_RECORD(high < LOG_DELTA_MAX ? high : LOG_DELTA_MAX, LOG_PIN_GAP, 0));
+		delta &= LOG_DELTA_MAX;
+	}
+	push(LOG_RECORD(delta, pin, value));
+	
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void eventLogChanges(uint32_t changed, uint32_t now){
+	while(changed != 0){
+		uint32_t pin = 31 - __builtin_clz(changed);
+		eventLogRecord(pin, now & (1U << pin));
+		changed &= ~(1U << pin);
+	}
+}
+
+// Copies records the reader has not seen yet; a reader that fell more than
+// LOG_SIZE behind skips forward and the lost records are counted as dropped.
+uint32_t eventLogDrain(uint32_t *tail, uint32_t *out, uint32_t max){
+	uint32_t head = EventLog.head;
+	if (head - *tail > LOG_SIZE){
+		EventLog.dropped += head - *tail - LOG_SIZE;
+		*tail = head - LOG_SIZE;
+	}
+	uint32_t n = 0;
+	while(*tail != head && n < max){
+		out[n++] = EventLog.records[*tail & (LOG_SIZE - 1)];
+		(*tail)++;
+	}
+	return n;
+}
+
+// Blocks for the EEPROM program time, call from task context only
+void eventLogPersist(void){
+#ifdef EVENTLOG_PERSIST
+	static uint32_t block[4 + EVENTLOG_PERSIST_COUNT];
+	
+	uint32_t tail = EventLog.head - EVENTLOG_PERSIST_COUNT;
+	if (EventLog.head < EVENTLOG_PERSIST_COUNT){
+		tail = 0;
+	}
+	uint32_t n = eventLogDrain(&tail, &block[4], EVENTLOG_PERSIST_COUNT);
+	block[0] = LOG_MAGIC;
+	block[1] = n;
+	block[2] = EventLog.dropped;
+	block[3] = EventLog.lastStamp;
+	nvmWrite(block, EVENTLOG_EEPROM_ADDR, (4 + n) * sizeof(uint32_t));
+#endif
+}
@@ -0,0 +1,54 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+
+// Record layout: bits 31-8 time delta, bits 7-1 pin, bit 0 value.
+// Deltas count (1 << LOG_TIME_SHIFT) CPU cycles since the previous record,
+// larger gaps are split off into a LOG_PIN_GAP record carrying the high bits.
+// A LOG_PIN_CLOCK record marks each clock switch (clock.h), so deltas after
+// it count cycles at the new frequency.
+//
+// The stamp is CYCCNT >> LOG_TIME_SHIFT and wraps every 2^32 cycles (54 s
+// at CLOCK_FULL, 18 min at CLOCK_LOW). Whole wraps in a gap are counted
+// from the RTOS tick that ran alongside and added to the GAP record, so a
+// gap is exact to the cycle up to 2^32 ticks (49.7 days); longer idle
+// gaps are short by whole tick-counter wraps.
+#define LOG_SIZE 256
+#define LOG_TIME_SHIFT 4
+#define LOG_STAMP_BITS (32 - LOG_TIME_SHIFT)
+#define LOG_DELTA_BITS 24
+#define LOG_DELTA_MAX ((1UL << LOG_DELTA_BITS) - 1)
+#define LOG_MAGIC 0x474F4C57UL
+
+// Pins are bit positions in the packed input word, port F uses lane 24-31
+#define LOG_PIN_JAM        5
+#define LOG_PIN_MOTOR_UP   16
+#define LOG_PIN_MOTOR_DOWN 17
+#define LOG_PIN_AUTO       28
+#define LOG_PIN_CLOCK      126   // value 1: CLOCK_FULL from here on, 0: CLOCK_LOW
+#define LOG_PIN_GAP        127
+
+#define LOG_RECORD(delta, pin, value) (((uint32_t)(delta) << 8) | ((uint32_t)(pin) << 1) | ((value) ? 1U : 0U))
+
+// EEPROM copy of the most recent records, same header layout as EventLog
+#define EVENTLOG_EEPROM_ADDR   0x600
+#define EVENTLOG_PERSIST_COUNT 96
+
+struct EventLog {
+	uint32_t magic;
+	uint32_t head;
+	uint32_t dropped;
+	uint32_t lastStamp;
+	uint32_t records[LOG_SIZE];
+};
+
+extern struct EventLog EventLog;
+
+void eventLogInit(void);
+void eventLogRecord(uint32_t pin, uint32_t value);
+void eventLogChanges(uint32_t changed, uint32_t now);
+uint32_t eventLogDrain(uint32_t *tail, uint32_t *out, uint32_t max);
+void eventLogPersist(void);
+
+#endif
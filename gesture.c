@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gesture.h"
+
+enum GestureState {
+	STATE_IDLE,
+	STATE_DOWN,       // pressed, manual travel while held
+	STATE_CONSUMED,   // pressed as the second half of a double tap
+	STATE_TAPPED      // released after a tap, waiting out doubleMs
+};
+
+struct GestureInput {
+	enum GestureState state;
+	enum GestureState released;   // state the last release left, for bounce
+	uint32_t pressedAt;
+	uint32_t releasedAt;
+	uint16_t holdMs;
+	uint16_t doubleMs;
+};
+
+volatile struct GestureStats GestureStats;
+
+#define INPUT_DEFAULT {STATE_IDLE, STATE_IDLE, 0, 0, GESTURE_HOLD_MS, GESTURE_DOUBLE_MS}
+
+static struct GestureInput Inputs[GESTURE_INPUTS] = {INPUT_DEFAULT, INPUT_DEFAULT, INPUT_DEFAULT, INPUT_DEFAULT};
+
+void gestureConfigure(uint32_t input, const struct GestureConfig *cfg){
+	if (input < GESTURE_INPUTS && cfg->holdMs > GESTURE_BOUNCE_MS){
+		Inputs[input].holdMs = cfg->holdMs;
+		Inputs[input].doubleMs = cfg->doubleMs;
+	}
+}
+
+static enum Gesture press(struct GestureInput *in, uint32_t now){
+	uint32_t gap = now - in->releasedAt;
+	if (in->state == STATE_IDLE || in->state == STATE_TAPPED){
+		if (gap < GESTURE_BOUNCE_MS && in->released != STATE_IDLE){
+			// Bounce on the release: carry on with the press it ended
+			GestureStats.bounces++;
+			in->state = in->released == STATE_CONSUMED ? STATE_CONSUMED : STATE_DOWN;
+			return GESTURE_NONE;
+		}
+		if (in->state == STATE_TAPPED && gap <= in->doubleMs){
+			GestureStats.doubleTaps++;
+			in->state = STATE_CONSUMED;
+			in->pressedAt = now;
+			return GESTURE_DOUBLE_TAP;
+		}
+	}
+	in->state = STATE_DOWN;
+	in->pressedAt = now;
+	return GESTURE_PRESS;
+}
+
+static enum Gesture release(struct GestureInput *in, uint32_t now){
+	enum GestureState was = in->state;
+	in->released = was;
+	in->releasedAt = now;
+	if (was == STATE_DOWN){
+		if (now - in->pressedAt < GESTURE_BOUNCE_MS){
+			GestureStats.bounces++;
+			in->released = STATE_IDLE;
+			in->state = STATE_IDLE;
+			return GESTURE_NONE;
+		}
+		if (now - in->pressedAt < in->holdMs){
+			GestureStats.taps++;
+			in->state = in->doubleMs != 0 ? STATE_TAPPED : STATE_IDLE;
+			return GESTURE_TAP;
+		}
+		GestureStats.holds++;
+		in->state = STATE_IDLE;
+		return GESTURE_HOLD;
+	}
+	in->state = STATE_IDLE;
+	return GESTURE_NONE;
+}
+
+// One edge of one input, nowMs from the sample that saw it. Repeated
+// levels (a press while already down) are ignored.
+enum Gesture gestureEvent(uint32_t input, bool pressed, uint32_t nowMs){
+	if (input >= GESTURE_INPUTS){
+		return GESTURE_NONE;
+	}
+	struct GestureInput *in = &Inputs[input];
+	bool down = in->state == STATE_DOWN || in->state == STATE_CONSUMED;
+	if (pressed == down){
+		return GESTURE_NONE;
+	}
+	return pressed ? press(in, nowMs) : release(in, nowMs);
+}
+
+// True while the input is pressed for manual travel; a press that made a
+// double tap does not count
+bool gestureHeld(uint32_t input){
+	return input < GESTURE_INPUTS && Inputs[input].state == STATE_DOWN;
+}
@@ -0,0 +1,59 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "preset.h"
+
+// Tap, hold and double tap on the direction switches. The engine is a
+// per-input state machine stepped only by press and release events with
+// their sample time, so it costs nothing while the switches are idle and
+// needs no timer: a press is classified when it ends.
+//
+//   press ........ the switch drives manually while held (GESTURE_PRESS)
+//   release < holdMs after press ........ GESTURE_TAP, express travel
+//   release >= holdMs after press ....... GESTURE_HOLD, manual travel ends
+//   press <= doubleMs after a tap ....... GESTURE_DOUBLE_TAP, go to preset;
+//                                         that press never drives manually
+//
+// Contact bounce: a press shorter than GESTURE_BOUNCE_MS is dropped, and a
+// release and press closer than that continue the original press.
+#define GESTURE_INPUTS 4
+#define GESTURE_BOUNCE_MS 20
+#define GESTURE_HOLD_MS 300
+#define GESTURE_DOUBLE_MS 400
+
+enum Gesture {
+	GESTURE_NONE,
+	GESTURE_PRESS,
+	GESTURE_TAP,
+	GESTURE_HOLD,
+	GESTURE_DOUBLE_TAP
+};
+
+// doubleMs 0 turns the double tap off for that input
+struct GestureConfig {
+	uint16_t holdMs;
+	uint16_t doubleMs;
+	uint32_t preset;   // enum Preset for the double tap
+};
+
+// Inputs in ButtonMasks order: driver up, driver down, passenger up, passenger down
+#define GESTURE_DEFAULTS { \
+	{GESTURE_HOLD_MS, GESTURE_DOUBLE_MS, PRESET_VENT}, {GESTURE_HOLD_MS, GESTURE_DOUBLE_MS, PRESET_HALF}, \
+	{GESTURE_HOLD_MS, GESTURE_DOUBLE_MS, PRESET_VENT}, {GESTURE_HOLD_MS, GESTURE_DOUBLE_MS, PRESET_HALF}}
+
+struct GestureStats {
+	uint32_t taps;
+	uint32_t holds;
+	uint32_t doubleTaps;
+	uint32_t bounces;
+};
+
+extern volatile struct GestureStats GestureStats;
+
+void gestureConfigure(uint32_t input, const struct GestureConfig *cfg);
+enum Gesture gestureEvent(uint32_t input, bool pressed, uint32_t nowMs);
+bool gestureHeld(uint32_t input);
+
+#endif
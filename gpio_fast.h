@@ -0,0 +1,103 @@
+#ifndef GPIO_FAST_H
+#define GPIO_FAST_H
+
+#include <stdint.h>
+#include "pins.h"
+
+// APB apertures of the ports we use
+#define FAST_PORTB_BASE 0x40005000UL
+#define FAST_PORTC_BASE 0x40006000UL
+#define FAST_PORTD_BASE 0x40007000UL
+#define FAST_PORTE_BASE 0x40024000UL
+#define FAST_PORTF_BASE 0x40025000UL
+
+#define FAST_GPIO_MIS 0x418UL
+#define FAST_GPIO_ICR 0x41CUL
+#define FAST_GPIO_PUR 0x510UL
+
+// Masked data register: address bits [9:2] select which pins a load/store
+// touches, so a store never needs a read-modify-write and a load returns
+// only the selected pins.
+#define GPIO_MASKED(base, mask) (*((volatile uint32_t *)((base) + ((uint32_t)(mask) << 2))))
+
+// Bit-band alias of a single peripheral register bit, reads back as 0 or 1
+#define BITBAND_PERIPH(addr, bit) (*((volatile uint32_t *)(0x42000000UL + (((uint32_t)(addr) - 0x40000000UL) << 5) + ((uint32_t)(bit) << 2))))
+#define GPIO_BIT(base, bit) BITBAND_PERIPH((base) + 0x3FCUL, bit)
+
+//////////////
+//	Pin masks
+//////////////
+// Generated from PIN_TABLE in pins.h
+#define PB_LIMIT_CLOSED   PIN_LIMIT_CLOSED
+#define PB_LIMIT_OPENED   PIN_LIMIT_OPENED
+#define PB_LOCK           PIN_LOCK
+#define PB_JAM            PIN_JAM
+#define PC_DRIVER_DOWN    PIN_DRIVER_DOWN
+#define PC_PASSENGER_UP   PIN_PASSENGER_UP
+#define PD_MOTOR_UP       PIN_MOTOR_UP
+#define PD_MOTOR_DOWN     PIN_MOTOR_DOWN
+#define PD_DRIVER_UP      PIN_DRIVER_UP
+#define PD_PASSENGER_DOWN PIN_PASSENGER_DOWN
+#define PE_CURRENT_SENSE  PIN_CURRENT_SENSE
+#define PF_AUTO           PIN_AUTO
+
+// The scan task samples plain inputs and the limit switches; the jam and
+// auto buttons only ever arrive as falling-edge interrupts
+#define ROLE_POLLED (ROLE_INPUT | ROLE_IRQ_BOTH)
+#define PB_INPUTS PORT_ROLE_PINS(PORT_B, ROLE_POLLED)
+#define PC_INPUTS PORT_ROLE_PINS(PORT_C, ROLE_POLLED)
+#define PD_INPUTS PORT_ROLE_PINS(PORT_D, ROLE_POLLED)
+#define PD_MOTOR  PORT_ROLE_PINS(PORT_D, ROLE_PWM)
+
+// The prefixes above are only names; catch a pin moved to another port
+_Static_assert(PIN_PORT_LIMIT_CLOSED == PORT_B && PIN_PORT_LIMIT_OPENED == PORT_B && PIN_PORT_LOCK == PORT_B && PIN_PORT_JAM == PORT_B, "PB_ pin not on port B");
+_Static_assert(PIN_PORT_DRIVER_DOWN == PORT_C && PIN_PORT_PASSENGER_UP == PORT_C, "PC_ pin not on port C");
+_Static_assert(PIN_PORT_MOTOR_UP == PORT_D && PIN_PORT_MOTOR_DOWN == PORT_D && PIN_PORT_DRIVER_UP == PORT_D && PIN_PORT_PASSENGER_DOWN == PORT_D, "PD_ pin not on port D");
+_Static_assert(PIN_PORT_CURRENT_SENSE == PORT_E && PIN_PORT_AUTO == PORT_F, "PE_/PF_ pin on wrong port");
+// M1PWM0/M1PWM1 only exist on PD0/PD1, and motorWrite() stores the pin
+// mask straight into PWM1 ENABLE
+_Static_assert(PD_MOTOR_UP == 0x01U && PD_MOTOR_DOWN == 0x02U, "motor pins must be PD0/PD1");
+
+#define MOTOR_OFF  0x00U
+#define MOTOR_UP   PD_MOTOR_UP
+#define MOTOR_DOWN PD_MOTOR_DOWN
+
+#ifdef SIMULATOR
+// Host build: pins, motor and interrupt status come from the plant model
+#include "sim_hw.h"
+#else
+static inline uint32_t gpioReadB(void){
+	return GPIO_MASKED(FAST_PORTB_BASE, PB_INPUTS);
+}
+
+static inline uint32_t gpioReadC(void){
+	return GPIO_MASKED(FAST_PORTC_BASE, PC_INPUTS);
+}
+
+static inline uint32_t gpioReadD(void){
+	return GPIO_MASKED(FAST_PORTD_BASE, PD_INPUTS);
+}
+
+// PD0/PD1 run as M1PWM0/M1PWM1. Enabling an output drives that side of the
+// H-bridge at the current duty and disabled outputs idle low, so both motor
+// pins change in one store and the bridge never sees up and down together.
+#define FAST_PWM1_ENABLE (*((volatile uint32_t *)0x40029008UL))
+
+static inline void motorWrite(uint32_t dir){
+	FAST_PWM1_ENABLE = dir;
+}
+
+static inline uint32_t motorRead(void){
+	return FAST_PWM1_ENABLE & PD_MOTOR;
+}
+
+static inline uint32_t gpioIntStatus(uint32_t base){
+	return *((volatile uint32_t *)(base + FAST_GPIO_MIS));
+}
+
+static inline void gpioIntClear(uint32_t base, uint32_t mask){
+	*((volatile uint32_t *)(base + FAST_GPIO_ICR)) = mask;
+}
+#endif
+
+#endif
@@ -0,0 +1,23 @@
+#include <stdint.h>
+#include "gpio_fast.h"
+#include "inputs.h"
+#include "eventlog.h"
+
+uint32_t inputsPack(uint32_t portB, uint32_t portC, uint32_t portD){
+	return ~(IN_LANE_B(portB) | IN_LANE_C(portC) | IN_LANE_D(portD)) & IN_ALL;
+}
+
+// Pure step so recorded snapshot streams can be replayed through the same logic
+void inputsUpdate(struct InputSnapshot *snap, uint32_t word){
+	snap->prev = snap->now;
+	snap->now = word;
+	snap->changed = snap->now ^ snap->prev;
+}
+
+// One load per port, everything after this works on the packed word
+void inputsSample(struct InputSnapshot *snap){
+	inputsUpdate(snap, inputsPack(gpioReadB(), gpioReadC(), gpioReadD()));
+	if (snap->changed != 0){
+		eventLogChanges(snap->changed, snap->now);
+	}
+}
@@ -0,0 +1,49 @@
+#ifndef INPUTS_H
+#define INPUTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio_fast.h"
+
+// Packed input word: port B in bits 0-7, port C in 8-15, port D in 16-23,
+// inverted so a set bit means the (active low) switch is closed.
+#define IN_LANE_B(mask) ((uint32_t)(mask))
+#define IN_LANE_C(mask) ((uint32_t)(mask) << 8)
+#define IN_LANE_D(mask) ((uint32_t)(mask) << 16)
+
+#define IN_LIMIT_CLOSED   IN_LANE_B(PB_LIMIT_CLOSED)
+#define IN_LIMIT_OPENED   IN_LANE_B(PB_LIMIT_OPENED)
+#define IN_LOCK           IN_LANE_B(PB_LOCK)
+#define IN_DRIVER_DOWN    IN_LANE_C(PC_DRIVER_DOWN)
+#define IN_PASSENGER_UP   IN_LANE_C(PC_PASSENGER_UP)
+#define IN_DRIVER_UP      IN_LANE_D(PD_DRIVER_UP)
+#define IN_PASSENGER_DOWN IN_LANE_D(PD_PASSENGER_DOWN)
+
+#define IN_UP_BUTTONS   (IN_DRIVER_UP | IN_PASSENGER_UP)
+#define IN_DOWN_BUTTONS (IN_DRIVER_DOWN | IN_PASSENGER_DOWN)
+// Limit switches are interrupt driven (limits.c) and not part of the polled word
+#define IN_ALL (IN_LOCK | IN_UP_BUTTONS | IN_DOWN_BUTTONS)
+
+struct InputSnapshot {
+	uint32_t now;
+	uint32_t prev;
+	uint32_t changed;
+};
+
+uint32_t inputsPack(uint32_t portB, uint32_t portC, uint32_t portD);
+void inputsUpdate(struct InputSnapshot *snap, uint32_t word);
+void inputsSample(struct InputSnapshot *snap);
+
+static inline bool inputActive(const struct InputSnapshot *snap, uint32_t mask){
+	return (snap->now & mask) != 0;
+}
+
+static inline bool inputPressed(const struct InputSnapshot *snap, uint32_t mask){
+	return (snap->changed & snap->now & mask) != 0;
+}
+
+static inline bool inputReleased(const struct InputSnapshot *snap, uint32_t mask){
+	return (snap->changed & ~snap->now & mask) != 0;
+}
+
+#endif
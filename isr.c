@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#ifndef SIMULATOR
+#include <driverlib/interrupt.h>
+#endif
+#include "cycles.h"
+#include "trace.h"
+#include "isr.h"
+
+volatile struct IsrStats IsrStats;
+
+static SemaphoreHandle_t deferSem;
+static StaticSemaphore_t deferSemBuffer;
+static IsrWorkFn Work[ISR_WORK_SLOTS];
+static volatile uint32_t Pending;
+static volatile uint32_t PendingStamp;
+
+// The simulator calls the handlers itself and has no NVIC
+#ifndef SIMULATOR
+// Priority is validated and written before the NVIC enable, so the
+// interrupt can never run above the kernel's syscall ceiling.
+void isrRegister(uint32_t interrupt, void (*handler)(void), uint32_t priority){
+	configASSERT(priority >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+	configASSERT(priority <= configLIBRARY_LOWEST_INTERRUPT_PRIORITY);
+	IntRegister(interrupt, handler);
+	IntPrioritySet(interrupt, priority << (8 - configPRIO_BITS));
+	IntEnable(interrupt);
+}
+#endif
+
+// The semaphore joins the consumer's queue set, the consumer calls
+// isrRunDeferred() whenever the set wakes it.
+void isrDeferInit(QueueSetHandle_t set){
+	deferSem = xSemaphoreCreateBinaryStatic(&deferSemBuffer);
+	xQueueAddToSet(deferSem, set);
+}
+
+// Runs the handlers for everything posted since the last call, returns
+// false if nothing was pending.
+bool isrRunDeferred(void){
+	if (xSemaphoreTake(deferSem, 0) == pdFALSE){
+		return false;
+	}
+	
+	taskENTER_CRITICAL();
+	uint32_t work = Pending;
+	uint32_t latency = cyclesToUs(cyclesNow() - PendingStamp);
+	Pending = 0;
+	taskEXIT_CRITICAL();
+	
+	IsrStats.wakes++;
+	IsrStats.latencyUsLast = latency;
+	if (latency > IsrStats.latencyUsMax){
+		IsrStats.latencyUsMax = latency;
+	}
+	
+	for(uint32_t i = 0; i < ISR_WORK_SLOTS; i++){
+		if ((work & (1U << i)) && Work[i] != NULL){
+			traceRecord(TRACE_WORK_BEGIN, i);
+			Work[i]();
+			traceRecord(TRACE_WORK_END, i);
+		}
+	}
+	return true;
+}
+
+void isrSetWork(uint32_t work, IsrWorkFn fn){
+	for(uint32_t i = 0; i < ISR_WORK_SLOTS; i++){
+		if (work & (1U << i)){
+			Work[i] = fn;
+		}
+	}
+}
+
+// Work posted while the task already has some pending rides along with
+// that wake, only the first bit set after a drain gives the semaphore.
+void isrDefer(uint32_t work, BaseType_t *woken){
+	UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	uint32_t was = Pending;
+	Pending = was | work;
+	if (was == 0){
+		PendingStamp = cyclesNow();
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	
+	IsrStats.deferred++;
+	if (was == 0){
+		xSemaphoreGiveFromISR(deferSem, woken);
+	}
+}
+
+// Same hand-off for work raised by a task, e.g. a jam seen in the current
+void isrDeferFromTask(uint32_t work){
+	taskENTER_CRITICAL();
+	uint32_t was = Pending;
+	Pending = was | work;
+	if (was == 0){
+		PendingStamp = cyclesNow();
+	}
+	taskEXIT_CRITICAL();
+	
+	IsrStats.deferred++;
+	if (was == 0){
+		xSemaphoreGive(deferSem);
+	}
+}
+
+void isrExit(BaseType_t woken){
+	IsrStats.interrupts++;
+	if (woken != pdFALSE){
+		IsrStats.switches++;
+	}
+	traceIsrExit(woken != pdFALSE);
+	portEND_SWITCHING_ISR(woken);
+}
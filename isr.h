@@ -0,0 +1,44 @@
+#ifndef ISR_H
+#define ISR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "queue.h"
+
+// Priorities are in library units (0 highest .. configLIBRARY_LOWEST_INTERRUPT_PRIORITY).
+// Anything calling FromISR APIs must be numerically >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY.
+#define ISR_PRIORITY_GPIO (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1)
+#define ISR_PRIORITY_ADC  (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 2)
+
+// Deferred work bits, one handler each, run lowest bit first. A pending
+// bit cannot be lost, so safety-relevant timer expiries come this way
+// too; a reversal that has ended is retired before a new jam starts one.
+#define ISR_WORK_JAM_END 0x01U   // TIMEOUT_JAM_REVERSE expired
+#define ISR_WORK_JAM     0x02U
+#define ISR_WORK_AUTO    0x04U
+#define ISR_WORK_LIMITS  0x08U   // TIMEOUT_LIMIT_DEBOUNCE expired
+#define ISR_WORK_SLOTS 8
+
+typedef void (*IsrWorkFn)(void);
+
+struct IsrStats {
+	uint32_t interrupts;
+	uint32_t switches;
+	uint32_t wakes;
+	uint32_t deferred;
+	uint32_t latencyUsLast;   // first deferred bit set to the handlers running
+	uint32_t latencyUsMax;
+};
+
+extern volatile struct IsrStats IsrStats;
+
+void isrRegister(uint32_t interrupt, void (*handler)(void), uint32_t priority);
+void isrDeferInit(QueueSetHandle_t set);
+bool isrRunDeferred(void);
+void isrSetWork(uint32_t work, IsrWorkFn fn);
+void isrDefer(uint32_t work, BaseType_t *woken);
+void isrDeferFromTask(uint32_t work);
+void isrExit(BaseType_t woken);
+
+#endif
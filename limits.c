@@ -0,0 +1,129 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "gpio_fast.h"
+#include "inputs.h"
+#include "eventlog.h"
+#include "motion.h"
+#include "spsc.h"
+#include "limits.h"
+#include "timeouts.h"
+
+#define LIMIT_PINS (IN_LIMIT_CLOSED | IN_LIMIT_OPENED)
+
+// Produced by the port B ISR, or by limitsPoll inside a critical section,
+// so there is only ever one producer running at a time.
+SPSC_DEFINE(LimitEvents, struct LimitEvent, 8);
+
+static volatile uint32_t Reported;
+static volatile uint32_t Pending;
+static TickType_t LastChange[2];
+
+static uint32_t readLevels(void){
+	return IN_LANE_B(~gpioReadB()) & LIMIT_PINS;
+}
+
+static void report(uint32_t pin, uint32_t level, TickType_t now){
+	struct LimitEvent ev = {pin, (level & pin) != 0, now};
+	Reported = (Reported & ~pin) | (level & pin);
+	LastChange[pin == IN_LIMIT_CLOSED ? 0 : 1] = now;
+	spscPush(&LimitEvents, &ev);
+	eventLogRecord(pin == IN_LIMIT_CLOSED ? 0 : 1, ev.reached);
+}
+
+// The first edge is accepted at once; edges inside the debounce window
+// only mark the pin so limitsPoll re-reads its settled level afterwards.
+static void settle(uint32_t pin, uint32_t level, TickType_t now){
+	if (now - LastChange[pin == IN_LIMIT_CLOSED ? 0 : 1] < pdMS_TO_TICKS(LIMIT_DEBOUNCE_MS)){
+		Pending |= pin;
+		return;
+	}
+	Pending &= ~pin;
+	if ((Reported ^ level) & pin){
+		report(pin, level, now);
+	}
+}
+
+// Ticks until the last pending pin's debounce window closes
+static TickType_t settleIn(TickType_t now){
+	TickType_t wait = 0;
+	for(uint32_t i = 0; i < 2; i++){
+		if (Pending & (i == 0 ? IN_LIMIT_CLOSED : IN_LIMIT_OPENED)){
+			TickType_t left = pdMS_TO_TICKS(LIMIT_DEBOUNCE_MS) - (now - LastChange[i]);
+			if (left > wait){
+				wait = left;
+			}
+		}
+	}
+	return wait;
+}
+
+void limitsInit(void){
+	uint32_t level = readLevels();
+	TickType_t now = xTaskGetTickCount() - pdMS_TO_TICKS(LIMIT_DEBOUNCE_MS);
+	LastChange[0] = now;
+	LastChange[1] = now;
+	Reported = 0;
+	Pending = 0;
+	if (level & IN_LIMIT_CLOSED){
+		report(IN_LIMIT_CLOSED, level, now);
+	}
+	if (level & IN_LIMIT_OPENED){
+		report(IN_LIMIT_OPENED, level, now);
+	}
+}
+
+void limitsISR(uint32_t status, BaseType_t *woken){
+	uint32_t level = readLevels();
+	uint32_t before = Reported;
+	TickType_t now = xTaskGetTickCountFromISR();
+	
+	if (status & PB_LIMIT_CLOSED){
+		settle(IN_LIMIT_CLOSED, level, now);
+	}
+	if (status & PB_LIMIT_OPENED){
+		settle(IN_LIMIT_OPENED, level, now);
+	}
+	if (Reported & ~before){
+		motionNotifyFromISR(MOTION_LIMIT, woken);
+	}
+	if (Pending){
+		timeoutStartFromISR(TIMEOUT_LIMIT_DEBOUNCE, settleIn(now), woken);
+	}
+}
+
+// Runs when TIMEOUT_LIMIT_DEBOUNCE expires to resolve pins that bounced
+void limitsPoll(void){
+	if (Pending == 0){
+		return;
+	}
+	taskENTER_CRITICAL();
+	uint32_t level = readLevels();
+	uint32_t before = Reported;
+	TickType_t now = xTaskGetTickCount();
+	if (Pending & IN_LIMIT_CLOSED){
+		settle(IN_LIMIT_CLOSED, level, now);
+	}
+	if (Pending & IN_LIMIT_OPENED){
+		settle(IN_LIMIT_OPENED, level, now);
+	}
+	uint32_t reached = Reported & ~before;
+	TickType_t wait = Pending ? settleIn(now) : 0;
+	taskEXIT_CRITICAL();
+	
+	if (reached){
+		motionNotify(MOTION_LIMIT);
+	}
+	if (wait != 0){
+		timeoutStart(TIMEOUT_LIMIT_DEBOUNCE, wait * portTICK_PERIOD_MS);
+	}
+}
+
+uint32_t limitsPop(struct LimitEvent *out, uint32_t max){
+	return spscPopBatch(&LimitEvents, out, max);
+}
+
+uint32_t limitsState(void){
+	return Reported;
+}
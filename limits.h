@@ -0,0 +1,23 @@
+#ifndef LIMITS_H
+#define LIMITS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+
+#define LIMIT_DEBOUNCE_MS 10
+
+// Debounced level change of one limit switch; pin is IN_LIMIT_CLOSED or IN_LIMIT_OPENED
+struct LimitEvent {
+	uint32_t pin;
+	bool reached;
+	TickType_t stamp;
+};
+
+void limitsInit(void);
+void limitsISR(uint32_t status, BaseType_t *woken);
+void limitsPoll(void);
+uint32_t limitsPop(struct LimitEvent *out, uint32_t max);
+uint32_t limitsState(void);
+
+#endif
@@ -5,158 +5,392 @@
 #include <time.h>
 #include <stdbool.h>
 #include <semphr.h>
+#ifndef SIMULATOR
 #include <driverlib/gpio.c>
 #include <driverlib/gpio.h>
 #include <driverlib/sysctl.h>
+#include <driverlib/interrupt.h>
 #include <inc/hw_ints.h>
+#endif
 #include "tm4c123gh6pm.h"
 #include "buttons.h"
+#include "gpio_fast.h"
+#include "pins.h"
+#include "inputs.h"
+#include "eventlog.h"
+#include "motion.h"
+#include "limits.h"
+#include "window.h"
+#include "isr.h"
+#include "watchdog.h"
+#include "boot.h"
+#include "current.h"
+#include "preset.h"
+#include "config.h"
+#include "trace.h"
+#include "profile.h"
+#include "timeouts.h"
+#include "closure.h"
+#include "protect.h"
+#include "clock.h"
+#include "gesture.h"
+#ifdef ENABLE_BENCHMARKS
+#include "bench.h"
+#endif
 
 #define Set_Bit(reg, bit) {reg |= (1U << bit);}
 #define Clear_Bit(reg, bit) {reg &= ~(1U << bit);}
 #define Toggle_Bit(reg, bit) {reg ^= (1U << bit);}
-#define Get_Bit(reg, bit) ((reg & (1U << bit)) >> bit);
+#define Get_Bit(reg, bit) (((reg) & (1U << (bit))) >> (bit))
 #define PortF_IRQn ((IRQn_Type) 30 )
 #define PortB_IRQn ((IRQn_Type) 1 )
-
-
-struct Window {
-	bool isFullyClosed;
-	bool isFullyOpened;
-	bool isLocked;
-	bool autoMode;
-};
+#define GPIO_CLOCKS PINS_CLOCKS
+#define TASK_STACK 100
+#define WINDOW_QUEUE_LEN 8
+// Deferred ISR work runs in the controller, which keeps the priority the
+// dedicated deferred task had so a jam still pre-empts the motion task
+#define CONTROLLER_PRIORITY 3
+// One slot per queued message plus the deferred-work semaphore
+#define WINDOW_SET_LEN (WINDOW_QUEUE_LEN + 1)
 
 static struct Window CarWindow;
-static struct Button PortC_Buttons[4];
-static SemaphoreHandle_t jamSemaphore;
-static SemaphoreHandle_t autoModeSemaphore;
+static const struct Button PortC_Buttons[4] = {{driver, up}, {driver, down}, {passenger, up}, {passenger, down}};
+static const uint32_t ButtonMasks[4] = {IN_DRIVER_UP, IN_DRIVER_DOWN, IN_PASSENGER_UP, IN_PASSENGER_DOWN};
+static struct InputSnapshot Inputs;
+static uint32_t InputWord;
+static QueueHandle_t windowQueue;
+static QueueSetHandle_t windowSet;
+static bool JamReversing;
+volatile struct Telemetry Telemetry;
+
+static StackType_t checkButtonsStack[TASK_STACK];
+static StaticTask_t checkButtonsTcb;
+static StackType_t controllerStack[TASK_STACK];
+static StaticTask_t controllerTcb;
+static uint8_t windowQueueStorage[WINDOW_QUEUE_LEN * sizeof(struct WindowMsg)];
+static StaticQueue_t windowQueueBuffer;
+static uint8_t windowSetStorage[WINDOW_SET_LEN * sizeof(QueueSetMemberHandle_t)];
+static StaticQueue_t windowSetBuffer;
 
 
 void CheckButtons(void *p);
+void windowController(void *p);
+void windowHandleMsg(const struct WindowMsg *msg);
+void windowTimeout(uint32_t id);
+bool postTimeout(uint32_t id);
+bool deferTimeout(uint32_t id);
+void sampleTelemetry(void);
+void postWindowMsg(enum WindowMsgType type, uint32_t arg, uint32_t value);
+void updateMotor(void);
+void gestureAction(uint32_t input, enum Gesture gesture);
 
 void init(void);
 void initStructs(void);
+void applyConfig(void);
 
-void jamHandler(void *p);
-void autoModeHandler(void *p);
+void jamHandler(void);
+void jamReverseEnd(void);
+void autoModeHandler(void);
 
-void jamInterrupt(void);
+void portBInterrupt(void);
 void autoModeInterrupt(void);
 
 bool hasPermission(enum User user);
 void moveWindow(struct Button currBtn);
-void limitSwitchHandler(int limitSwitch);
+void limitSwitchHandler(int limitSwitch, bool reached);
 void stopWindow(void);
-void delayMS(int ms);
+void motionFinished(uint32_t reason);
 
-void delayMS(int ms){
-	int CTR = 0;
-	while(CTR < ms*3100) CTR++;
-}
+#ifdef SIMULATOR
+// The host simulator boots the firmware, and reboots it after a watchdog
+// reset, by calling this main itself
+#define main firmwareMain
+#endif
 
 int main(void){
+	bootStamp(BOOT_MAIN);
+	clockInit();
+	configLoad();
+	applyConfig();
+	bootStamp(BOOT_CONFIG);
 	initStructs();
+	eventLogInit();
+	traceInit();
+	// xQueueCreateSetStatic only arrives in FreeRTOS 11, this is its body
+	windowSet = xQueueGenericCreateStatic(WINDOW_SET_LEN, sizeof(QueueSetMemberHandle_t), windowSetStorage, &windowSetBuffer, queueQUEUE_TYPE_SET);
+	isrDeferInit(windowSet);
+	isrSetWork(ISR_WORK_JAM_END, jamReverseEnd);
+	isrSetWork(ISR_WORK_JAM, jamHandler);
+	isrSetWork(ISR_WORK_AUTO, autoModeHandler);
+	isrSetWork(ISR_WORK_LIMITS, limitsPoll);
+	timeoutsInit();
+	timeoutSetup(TIMEOUT_JAM_REVERSE, deferTimeout, false);
+	timeoutSetup(TIMEOUT_LIMIT_DEBOUNCE, deferTimeout, false);
+	timeoutSetup(TIMEOUT_TELEMETRY, postTimeout, true);
 	init();
+	bootStamp(BOOT_INIT);
+#ifdef ENABLE_BENCHMARKS
+	runBenchmarks();
+#endif
 	
-	jamSemaphore = xSemaphoreCreateBinary();
-	autoModeSemaphore = xSemaphoreCreateBinary();
+	windowQueue = xQueueCreateStatic(WINDOW_QUEUE_LEN, sizeof(struct WindowMsg), windowQueueStorage, &windowQueueBuffer);
+	xQueueAddToSet(windowQueue, windowSet);
+	windowPublish(&CarWindow);
+	Telemetry.queueFreeMin = WINDOW_QUEUE_LEN;
+	timeoutStart(TIMEOUT_TELEMETRY, TELEMETRY_PERIOD_MS);
 	
-	xTaskCreate(CheckButtons, "CheckButtons", 100, NULL, 1, NULL);
-	xTaskCreate(jamHandler, "jamHandler", 100, NULL, 2, NULL);
-	xTaskCreate(autoModeHandler, "autoModeHandler", 100, NULL, 2, NULL);
+	xTaskCreateStatic(CheckButtons, "CheckButtons", TASK_STACK, NULL, 1, checkButtonsStack, &checkButtonsTcb);
+	xTaskCreateStatic(windowController, "controller", TASK_STACK, NULL, CONTROLLER_PRIORITY, controllerStack, &controllerTcb);
+	motionInit(motionFinished);
+	watchdogInit(LIVE_ALL);
 	
+	bootStamp(BOOT_SCHEDULER);
+	profileStart();
 	vTaskStartScheduler();
 	return 0;
 }
 
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *size){
+	static StaticTask_t idleTcb;
+	static StackType_t idleStack[configMINIMAL_STACK_SIZE];
+	*tcb = &idleTcb;
+	*stack = idleStack;
+	*size = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *size){
+	static StaticTask_t timerTcb;
+	static StackType_t timerStack[configTIMER_TASK_STACK_DEPTH];
+	*tcb = &timerTcb;
+	*stack = timerStack;
+	*size = configTIMER_TASK_STACK_DEPTH;
+}
+
 void CheckButtons(void *p){
+	(void)p;
 	
 	for( ; ; ){
 		
-		bool isZero = true;
-		
-		uint32_t bit = Get_Bit(GPIO_PORTB_DATA_R, 4);
-		if (bit == 0) {
-			CarWindow.isLocked = true;
+		inputsSample(&Inputs);
+		bootStamp(BOOT_FIRST_INPUT);
+		if (Inputs.changed != 0){
+			postWindowMsg(MSG_INPUTS, xTaskGetTickCount(), Inputs.now);
 		}
-		else if (bit == 1) {
-			CarWindow.isLocked = false;
+		
+		struct LimitEvent limitEvents[4];
+		uint32_t n = limitsPop(limitEvents, 4);
+		for(uint32_t i = 0; i < n; i++){
+			postWindowMsg(MSG_LIMIT, limitEvents[i].pin == IN_LIMIT_CLOSED ? 0 : 1, limitEvents[i].reached);
 		}
 		
-		for(int i = 4; i < 8; i++){
-			bit = Get_Bit(GPIO_PORTC_DATA_R, i);
-			if(i == 4) {
-				bit = Get_Bit(GPIO_PORTD_DATA_R, 2);
-			}
-			else if(i == 7) {
-				bit = Get_Bit(GPIO_PORTD_DATA_R, 3);
-			}
-			if (bit == 0){
-				moveWindow(PortC_Buttons[i-4]);
-				isZero = false;
+		watchdogCheckIn(LIVE_INPUT);
+#ifdef WATCHDOG_INJECT_HANG
+		// Simulator fault injection: the input task stops checking in
+		if (xTaskGetTickCount() > pdMS_TO_TICKS(WATCHDOG_INJECT_HANG)){
+			for(;;){
+				taskYIELD();
 			}
 		}
-		if(isZero && !CarWindow.autoMode){
-			stopWindow();
+#endif
+		vTaskDelay(pdMS_TO_TICKS(Config.scanPeriodMs));
+	}
+}
+
+// Only this task writes CarWindow, everybody else posts a message and
+// reads the published copy with windowRead. Messages and deferred work
+// (jam, auto button, jam reversal and limit debounce expiries) arrive
+// through one queue set; pending work always runs before the next queued
+// message.
+void windowController(void *p){
+	(void)p;
+	struct WindowMsg msg;
+	for(;;) {
+		watchdogCheckIn(LIVE_CONTROLLER);
+		QueueSetMemberHandle_t ready = xQueueSelectFromSet(windowSet, pdMS_TO_TICKS(LIVENESS_PERIOD_MS));
+		if (ready == NULL){
+			continue;
 		}
-		
-		bit = Get_Bit(GPIO_PORTB_DATA_R, 0);
-		if (bit == 0){
-			limitSwitchHandler(0);
-			while(bit == 0){bit = Get_Bit(GPIO_PORTB_DATA_R, 0);}
+		// Work is drained on every wake, so the semaphore's own set entry
+		// may find it already done and fall through
+		bool changed = isrRunDeferred();
+		if (ready == windowQueue && xQueueReceive(windowQueue, &msg, 0) == pdTRUE){
+			windowHandleMsg(&msg);
+			changed = true;
 		}
-		
-		bit = Get_Bit(GPIO_PORTB_DATA_R, 1);
-		if (bit == 0){
-			limitSwitchHandler(1);
-			while(bit == 0){bit = Get_Bit(GPIO_PORTB_DATA_R, 1);}
+		if (!changed){
+			continue;
 		}
+		updateMotor();
+		windowPublish(&CarWindow);
 	}
 }
 
-void jamHandler(void *p){
-	for(;;) {
-		xSemaphoreTake(jamSemaphore, portMAX_DELAY);
-		CarWindow.autoMode = false;
-		Clear_Bit(GPIO_PORTD_DATA_R, 0);
-		Set_Bit(GPIO_PORTD_DATA_R, 1);
-		delayMS(500);
-		Clear_Bit(GPIO_PORTD_DATA_R, 0);
-		Clear_Bit(GPIO_PORTD_DATA_R, 1);
+void windowHandleMsg(const struct WindowMsg *msg){
+	switch(msg->type){
+		case MSG_INPUTS:
+			// arg is the tick of the sample that saw the change
+			for(uint32_t i = 0; i < 4; i++){
+				if ((InputWord ^ msg->value) & ButtonMasks[i]){
+					gestureAction(i, gestureEvent(i, (msg->value & ButtonMasks[i]) != 0, msg->arg * portTICK_PERIOD_MS));
+				}
+			}
+			InputWord = msg->value;
+			CarWindow.isLocked = (InputWord & IN_LOCK) != 0;
+			break;
+		case MSG_LIMIT:
+			limitSwitchHandler(msg->arg, msg->value);
+			break;
+		case MSG_MOTION_DONE:
+			// A command taken after this job ended is already running
+			if (!motionActive()){
+				CarWindow.autoMode = false;
+			}
+			break;
+		case MSG_PRESET:
+			CarWindow.autoMode = motionGoto(presetTarget((enum Preset)msg->arg));
+			break;
+		case MSG_TIMEOUT:
+			windowTimeout(msg->arg);
+			break;
+	}
+}
+
+void windowTimeout(uint32_t id){
+	switch(id){
+		case TIMEOUT_TELEMETRY:
+			sampleTelemetry();
+			break;
 	}
 }
 
-void jamInterrupt(void) {
+// Timer callbacks run in the service task and must never block it. A
+// full queue drops the message, which only telemetry can afford.
+bool postTimeout(uint32_t id){
+	struct WindowMsg msg = {MSG_TIMEOUT, id, 0};
+	return xQueueSend(windowQueue, &msg, 0) == pdTRUE;
+}
+
+// Expiries the window's safety depends on set a deferred work bit
+// instead, which is never dropped and runs ahead of queued messages
+bool deferTimeout(uint32_t id){
+	isrDeferFromTask(id == TIMEOUT_JAM_REVERSE ? ISR_WORK_JAM_END : ISR_WORK_LIMITS);
+	return true;
+}
+
+void sampleTelemetry(void){
+	Telemetry.samples++;
+	Telemetry.position = closurePosition();
+	Telemetry.heatPct = ProtectStats.heatPct;
+	Telemetry.isrLatencyUsMax = IsrStats.latencyUsMax;
+	Telemetry.timerLatencyUsMax = TimeoutStats.latencyUsMax;
+	UBaseType_t free = uxQueueSpacesAvailable(windowQueue);
+	if (free < Telemetry.queueFreeMin){
+		Telemetry.queueFreeMin = free;
+	}
+	// Measured from the controller, which runs just below the service task
+	timeoutProbe();
+}
+
+void postWindowMsg(enum WindowMsgType type, uint32_t arg, uint32_t value){
+	struct WindowMsg msg = {type, arg, value};
+	xQueueSend(windowQueue, &msg, portMAX_DELAY);
+}
+
+// Presses and holds drive through updateMotor; a tap continues as
+// express travel to the end, a double tap goes to the input's preset.
+void gestureAction(uint32_t input, enum Gesture gesture){
+	struct Button btn = PortC_Buttons[input];
+	if (JamReversing || !hasPermission(btn.user)){
+		return;
+	}
+	if (gesture == GESTURE_TAP){
+		if (!(btn.dir == up ? CarWindow.isFullyClosed : CarWindow.isFullyOpened)){
+			motionStart(btn.dir == up ? MOTOR_UP : MOTOR_DOWN);
+			CarWindow.autoMode = true;
+		}
+	}
+	else if (gesture == GESTURE_DOUBLE_TAP){
+		// A rejected preset (position not calibrated) leaves the tap's travel running
+		if (motionGoto(presetTarget((enum Preset)Config.gestures[input].preset))){
+			CarWindow.autoMode = true;
+		}
+	}
+}
+
+void updateMotor(void){
+	// The jam reversal owns the motor until TIMEOUT_JAM_REVERSE
+	if (JamReversing){
+		return;
+	}
+	bool isZero = true;
+	for(int i = 0; i < 4; i++){
+		if (gestureHeld(i)){
+			moveWindow(PortC_Buttons[i]);
+			isZero = false;
+		}
+	}
+	if(isZero && !CarWindow.autoMode){
+		stopWindow();
+	}
+	if(!CarWindow.autoMode && motionActive()){
+		motionNotify(MOTION_CANCEL);
+	}
+}
+
+// Deferred from portBInterrupt or the motion task's current check, runs
+// in the controller. An auto job sees MOTION_JAM and ends without touching
+// the motor, so the reversal runs its full Config.jamReverseMs.
+void jamHandler(void){
+	CarWindow.autoMode = false;
+	motionNotify(MOTION_JAM);
+	driveMotor(MOTOR_DOWN);
+	JamReversing = true;
+	timeoutStart(TIMEOUT_JAM_REVERSE, Config.jamReverseMs);
+}
+
+// Deferred from the TIMEOUT_JAM_REVERSE expiry
+void jamReverseEnd(void){
+	JamReversing = false;
+	driveMotor(MOTOR_OFF);
+	eventLogPersist();
+}
+
+void portBInterrupt(void) {
 	
-	GPIOIntClear(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3 | GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6 | GPIO_PIN_7);
+	traceIsrEnter();
+	uint32_t status = gpioIntStatus(FAST_PORTB_BASE);
+	gpioIntClear(FAST_PORTB_BASE, status);
 	
-	portBASE_TYPE xHigherPriorityTaskWoken = ( ( BaseType_t ) 2 );
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	
-  xSemaphoreGiveFromISR(jamSemaphore, &xHigherPriorityTaskWoken);
+	if (status & (PB_LIMIT_CLOSED | PB_LIMIT_OPENED)){
+		limitsISR(status, &xHigherPriorityTaskWoken);
+	}
+	if (status & PB_JAM){
+		eventLogRecord(LOG_PIN_JAM, 1);
+		isrDefer(ISR_WORK_JAM, &xHigherPriorityTaskWoken);
+	}
 
-	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+	isrExit(xHigherPriorityTaskWoken);
 }
 
 
 
-void autoModeHandler(void *p){
-	for(;;) {
-		xSemaphoreTake(autoModeSemaphore, portMAX_DELAY);
-	
-		CarWindow.autoMode = ! CarWindow.autoMode;
-	}
+void autoModeHandler(void){
+	CarWindow.autoMode = !CarWindow.autoMode;
 }
 
 void autoModeInterrupt(void) {
 	
-	GPIOIntClear(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3 | GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_6 | GPIO_PIN_7);
+	traceIsrEnter();
+	gpioIntClear(FAST_PORTF_BASE, PF_AUTO);
+	eventLogRecord(LOG_PIN_AUTO, 1);
 
-	portBASE_TYPE xHigherPriorityTaskWoken = ( ( BaseType_t ) 2 );
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-	xSemaphoreGiveFromISR(autoModeSemaphore, &xHigherPriorityTaskWoken);
+	isrDefer(ISR_WORK_AUTO, &xHigherPriorityTaskWoken);
 
-	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+	isrExit(xHigherPriorityTaskWoken);
 }
 
 
@@ -167,95 +401,64 @@ bool hasPermission(enum User user){
   return true;
 }
 
-bool checkAutoUp( void ){
-	uint32_t upDriverBit = Get_Bit(GPIO_PORTD_DATA_R, 2);
-	uint32_t upPassengerBit = Get_Bit(GPIO_PORTC_DATA_R, 6);
-	if ( upDriverBit == 0 || upPassengerBit == 0 ){
-		return true;
-	}
-	return false;
-}
-bool checkAutoDown( void ){
-	uint32_t downDriverBit = Get_Bit(GPIO_PORTC_DATA_R, 5);
-	uint32_t downPassengerBit = Get_Bit(GPIO_PORTD_DATA_R, 3);
-	if ( downDriverBit == 0 || downPassengerBit == 0 ){
-		return true;
-	}
-	return false;
-}
 void moveWindow(struct Button currBtn){
 	if (! hasPermission(currBtn.user)){
-		Clear_Bit(GPIO_PORTD_DATA_R, 0);
-		Clear_Bit(GPIO_PORTD_DATA_R, 1);
+		if (! motionActive()){
+			driveMotor(MOTOR_OFF);
+		}
 		return;
 	}
 	if (! CarWindow.autoMode){
 		if (currBtn.dir == up){
-			if (! CarWindow.isFullyClosed){
-				Set_Bit(GPIO_PORTD_DATA_R, 0);
-				Clear_Bit(GPIO_PORTD_DATA_R, 1);
-			}
+			driveMotor(CarWindow.isFullyClosed ? MOTOR_OFF : MOTOR_UP);
 		}
 		else if (currBtn.dir == down){
-			if (! CarWindow.isFullyOpened){
-				Clear_Bit(GPIO_PORTD_DATA_R, 0);
-				Set_Bit(GPIO_PORTD_DATA_R, 1);
-			}
+			driveMotor(CarWindow.isFullyOpened ? MOTOR_OFF : MOTOR_DOWN);
 		}
 	}
-	else{
-		if (currBtn.dir == up){
-			while(! CarWindow.isFullyClosed && CarWindow.autoMode){
-				uint32_t bit = Get_Bit(GPIO_PORTB_DATA_R, 0);
-				if (bit == 0){
-					limitSwitchHandler(0);
-					while(bit == 0){bit = Get_Bit(GPIO_PORTB_DATA_R, 0);}
-					continue;
-				}
-				else if ( checkAutoDown() ){
-					CarWindow.autoMode = false;
-					continue;
-				}
-				else{
-					Set_Bit(GPIO_PORTD_DATA_R, 0);
-					Clear_Bit(GPIO_PORTD_DATA_R, 1);
-				}
-			}
+	else if (! motionActive()){
+		if (currBtn.dir == up && ! CarWindow.isFullyClosed){
+			motionStart(MOTOR_UP);
 		}
-		else if (currBtn.dir == down){
-			while(! CarWindow.isFullyOpened && CarWindow.autoMode){
-				uint32_t bit = Get_Bit(GPIO_PORTB_DATA_R, 1);
-				if (bit == 0){
-					limitSwitchHandler(1);
-					while(bit == 0){bit = Get_Bit(GPIO_PORTB_DATA_R, 1);}
-					continue;
-				}
-				else if ( checkAutoUp() ){
-					CarWindow.autoMode = false;
-					continue;
-				}
-				else{
-					Clear_Bit(GPIO_PORTD_DATA_R, 0);
-					Set_Bit(GPIO_PORTD_DATA_R, 1);
-				}
-			}
+		else if (currBtn.dir == down && ! CarWindow.isFullyOpened){
+			motionStart(MOTOR_DOWN);
 		}
 	}
+	else if ((currBtn.dir == up) != (motionDirection() == MOTOR_UP)){
+		CarWindow.autoMode = false;
+		motionNotify(MOTION_CANCEL);
+	}
 }
 
 void stopWindow(void){
-	Clear_Bit(GPIO_PORTD_DATA_R, 0);
-	Clear_Bit(GPIO_PORTD_DATA_R, 1);
+	driveMotor(MOTOR_OFF);
 }
 
-void limitSwitchHandler(int limitSwitch){
+void limitSwitchHandler(int limitSwitch, bool reached){
   if (limitSwitch == 0){
-		CarWindow.isFullyClosed = !CarWindow.isFullyClosed;
+		CarWindow.isFullyClosed = reached;
   }
   else if (limitSwitch == 1){
-		CarWindow.isFullyOpened = !CarWindow.isFullyOpened;
+		CarWindow.isFullyOpened = reached;
   }
-	CarWindow.autoMode = false;
+	if (reached){
+		CarWindow.autoMode = false;
+		motionNotify(MOTION_LIMIT);
+	}
+}
+
+void motionFinished(uint32_t reason){
+	postWindowMsg(MSG_MOTION_DONE, 0, reason);
+}
+
+void applyConfig(void){
+	closureConfigure(&Config.profile);
+	for(uint32_t i = 0; i < PRESETS; i++){
+		presetConfigure((enum Preset)i, Config.presets[i]);
+	}
+	for(uint32_t i = 0; i < GESTURE_INPUTS; i++){
+		gestureConfigure(i, &Config.gestures[i]);
+	}
 }
 
 void initStructs(void){
@@ -263,128 +466,43 @@ void initStructs(void){
 	CarWindow.isFullyOpened = false;
 	CarWindow.isLocked = false;
 	CarWindow.autoMode = false;
-	
-	static struct Button driverUpButton;
-	static struct Button driverDownButton;
-	static struct Button passengerUpButton;
-	static struct Button passengerDownButton;
-	
-	driverUpButton.user = driver;
-	driverUpButton.dir = up;
-	
-	driverDownButton.user = driver;
-	driverDownButton.dir = down;
-	
-	passengerUpButton.user = passenger;
-	passengerUpButton.dir = up;
-	
-	passengerDownButton.user = passenger;
-	passengerDownButton.dir = down;
-	
-	PortC_Buttons[0] = driverUpButton;
-	PortC_Buttons[1] = driverDownButton;
-	PortC_Buttons[2] = passengerUpButton;
-	PortC_Buttons[3] = passengerDownButton;
+	watchdogRecover(&CarWindow);
 }
 
+// On the host the pins, edges and handlers are the simulator's; only the
+// drivers with state of their own are initialised
 void init(void){
-
-	//PORT F SETUP
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
-	while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF));
+#ifndef SIMULATOR
+	//PORT B, C, D, E & F SETUP
+	// One clock gate write, then a single wait for every port in the pin table
+	SYSCTL_RCGCGPIO_R |= GPIO_CLOCKS;
+	while((SYSCTL_PRGPIO_R & GPIO_CLOCKS) != GPIO_CLOCKS);
 	
-	//PORT B SETUP
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-	while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOB));
+	// Inputs, pull-ups and edges come from PIN_TABLE (pins.h)
+	pinsInit();
 	
-	//PORT C SETUP
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
-	while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOC));
-	
-	//PORT D SETUP
-	SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
-	while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOD));
-	
-	//Manual/Auto Button Setup
-	GPIOPinTypeGPIOInput(GPIO_PORTF_BASE , GPIO_PIN_4 );
-	GPIOIntRegister(GPIO_PORTF_BASE, autoModeInterrupt);
-	GPIOIntTypeSet(GPIO_PORTF_BASE, GPIO_PIN_4, GPIO_FALLING_EDGE);
-	GPIOIntEnable(GPIO_PORTF_BASE, GPIO_INT_PIN_4 );
-	Set_Bit(GPIO_PORTF_PUR_R, 4);
-	
-	//Jam Button Setup
-	GPIOPinTypeGPIOInput(GPIO_PORTB_BASE , GPIO_PIN_5 );
-	GPIOIntRegister(GPIO_PORTB_BASE, jamInterrupt);
-	GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_PIN_5, GPIO_FALLING_EDGE);
-	GPIOIntEnable(GPIO_PORTB_BASE, GPIO_INT_PIN_5 );
-	Set_Bit(GPIO_PORTB_PUR_R, 5);
+	//Manual/Auto & Jam Buttons
+	GPIOIntEnable(FAST_PORTF_BASE, PF_AUTO);
+	GPIOIntEnable(FAST_PORTB_BASE, PB_JAM);
+#endif
 	
 	//Motor Pins Setup
- 	GPIOPinTypeGPIOOutput(GPIO_PORTD_BASE , GPIO_PIN_0 | GPIO_PIN_1 );
-	
-	//Limit Switch Pins Setup
-  GPIOPinTypeGPIOInput(GPIO_PORTB_BASE , GPIO_PIN_0 | GPIO_PIN_1 );
-	GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_FALLING_EDGE);
-	Set_Bit(GPIO_PORTB_PUR_R, 0);
-	Set_Bit(GPIO_PORTB_PUR_R, 1);
-	
-	//On/Off Switch Pins Setup
-  GPIOPinTypeGPIOInput(GPIO_PORTB_BASE , GPIO_PIN_4 );
-	GPIOIntTypeSet(GPIO_PORTB_BASE, GPIO_PIN_4, GPIO_FALLING_EDGE);
-	Set_Bit(GPIO_PORTB_PUR_R, 4);
-	
-	//Up and Down Pins Setup
-	GPIOPinTypeGPIOInput(GPIO_PORTC_BASE , GPIO_PIN_5 | GPIO_PIN_6 );
-	GPIOIntTypeSet(GPIO_PORTC_BASE, GPIO_PIN_5 | GPIO_PIN_6 , GPIO_FALLING_EDGE);
-	Set_Bit(GPIO_PORTC_PUR_R, 5);
-	Set_Bit(GPIO_PORTC_PUR_R, 6);
+	motorPwmInit();
+	currentInit();
 	
-	GPIOPinTypeGPIOInput(GPIO_PORTD_BASE , GPIO_PIN_2 | GPIO_PIN_3 );
-	GPIOIntTypeSet(GPIO_PORTD_BASE, GPIO_PIN_2 | GPIO_PIN_3, GPIO_FALLING_EDGE);
-	Set_Bit(GPIO_PORTD_PUR_R, 2);
-	Set_Bit(GPIO_PORTD_PUR_R, 3);
+	//Limit Switches, enabled once the debouncer holds their initial level
+	limitsInit();
+#ifndef SIMULATOR
+	GPIOIntEnable(FAST_PORTB_BASE, PB_LIMIT_CLOSED | PB_LIMIT_OPENED);
 	
-	// Enable the Interrupt for PortF & PortB in NVIC
+	// Register PortF, PortB & ADC handlers, priority is set before the NVIC enable
+	isrRegister(INT_GPIOF, autoModeInterrupt, ISR_PRIORITY_GPIO);
+	isrRegister(INT_GPIOB, portBInterrupt, ISR_PRIORITY_GPIO);
+	isrRegister(INT_ADC0SS3, currentInterrupt, ISR_PRIORITY_ADC);
 	__asm("CPSIE I");
 	IntMasterEnable();
-	IntEnable(INT_GPIOF);
-	IntEnable(INT_GPIOB);
-	IntPrioritySet(INT_GPIOF, 0xE0);
-	IntPrioritySet(INT_GPIOB, 0xE0);
+#endif
 }
 
 
-//////////////
-//	Manual/Auto Button
-//////////////
-// F0
-
-//////////////
-//	Up & Down
-//////////////
-// C4 -> D2 (Now)
-// C5
-// C6
-// C7 -> D3 (Now)
-
-//////////////
-//	Limit Switches
-//////////////
-// B0
-// B1
-
-//////////////
-//	On/Off Switch
-//////////////
-// B4
-
-//////////////
-//	Jam Switch
-//////////////
-// B5
-
-//////////////
-//	Motor Pins
-/////////////
-// D0
-// D1
\ No newline at end of file
+// Pin map: PIN_TABLE in pins.h
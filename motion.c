@@ -0,0 +1,270 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "queue.h"
+#include "gpio_fast.h"
+#include "eventlog.h"
+#include "motion.h"
+#include "watchdog.h"
+#include "closure.h"
+#include "current.h"
+#include "protect.h"
+#include "isr.h"
+#include "config.h"
+#include "preset.h"
+#include "inputs.h"
+#include "limits.h"
+#include "timeouts.h"
+#include "clock.h"
+
+static TaskHandle_t motionHandle;
+static StackType_t motionStack[100];
+static StaticTask_t motionTcb;
+static MotionDoneFn motionDone;
+static volatile uint32_t Target = MOTOR_OFF;
+static volatile bool Active;
+
+// Single-slot command mailbox: a new target overwrites one not yet taken
+// and pre-empts the travel in progress
+static QueueHandle_t cmdQueue;
+static StaticQueue_t cmdQueueBuffer;
+static uint8_t cmdQueueStorage[sizeof(uint32_t)];
+static uint32_t Goal;
+static volatile uint32_t Cap = 1000;
+
+static TickType_t LastRun;
+
+static uint32_t dutyFor(uint32_t dir){
+	uint32_t duty = closureDutyFor(dir);
+	uint32_t limit = protectDutyLimit();
+	if (Cap < limit){
+		limit = Cap;
+	}
+	return duty < limit ? duty : limit;
+}
+
+// The motor starts at whatever clock is running (PWM is re-derived at both
+// points) and only then does the clock come up, so no start, a jam reversal
+// least of all, waits for the PLL to lock.
+void driveMotor(uint32_t dir){
+	if (!protectPermit(dir)){
+		dir = MOTOR_OFF;
+	}
+	uint32_t changed = motorRead() ^ dir;
+	if (changed != 0){
+		eventLogChanges(changed << 16, dir << 16);
+		motorSetDuty(dutyFor(dir));
+		motorWrite(dir);
+		if (dir != MOTOR_OFF){
+			clockSelect(CLOCK_FULL);
+		}
+		if (dir != MOTOR_OFF && motionHandle != NULL){
+			xTaskNotify(motionHandle, 0, eNoAction);
+		}
+	}
+}
+
+static TickType_t profileWait(void){
+	return pdMS_TO_TICKS(motorRead() != MOTOR_OFF ? PROFILE_PERIOD_MS : LIVENESS_PERIOD_MS);
+}
+
+// Travel times live in the configuration record loaded at boot
+static void travelLoad(void){
+	if (Config.travel.upMs != 0 && Config.travel.downMs != 0){
+		closureSetTravel(&Config.travel);
+	}
+}
+
+static void travelStore(void){
+	if (closureTakeLearned(&Config.travel)){
+		configSave();
+	}
+}
+
+// A current jam on the way up takes the same reversal path as the jam
+// input; stall and thermal trips just stop the motor. An idle motor
+// drops the clock to CLOCK_LOW after CLOCK_IDLE_MS.
+static void profileStep(void){
+	uint32_t dir = motorRead();
+	TickType_t now = xTaskGetTickCount();
+	closureStep(dir, motorDuty(), now);
+	uint32_t faults = protectStep(dir, currentReadMa(dir != MOTOR_OFF ? motorDuty() : 0), now);
+	if (faults & PROTECT_JAM){
+		isrDeferFromTask(ISR_WORK_JAM);
+	}
+	if (faults & (PROTECT_STALL | PROTECT_THERMAL)){
+		driveMotor(MOTOR_OFF);
+		motionNotify(MOTION_STALL);
+	}
+	else if (dir != MOTOR_OFF){
+		motorSetDuty(dutyFor(dir));
+	}
+	else {
+		travelStore();
+		// Suspended so the controller cannot start the motor between the
+		// check and the switch
+		if (now - LastRun >= pdMS_TO_TICKS(CLOCK_IDLE_MS)){
+			vTaskSuspendAll();
+			if (motorRead() == MOTOR_OFF){
+				clockSelect(CLOCK_LOW);
+			}
+			xTaskResumeAll();
+		}
+	}
+	if (dir != MOTOR_OFF){
+		LastRun = now;
+	}
+}
+
+// Direction towards goal, MOTOR_OFF if already there
+static uint32_t directionTo(uint32_t goal){
+	uint32_t limits = limitsState();
+	uint32_t pos = closurePosition();
+	if (goal == POSITION_CLOSED){
+		return (limits & IN_LIMIT_CLOSED) ? MOTOR_OFF : MOTOR_UP;
+	}
+	if (goal == POSITION_OPEN){
+		return (limits & IN_LIMIT_OPENED) ? MOTOR_OFF : MOTOR_DOWN;
+	}
+	if (goal > pos + TARGET_WINDOW){
+		return MOTOR_UP;
+	}
+	if (goal + TARGET_WINDOW < pos){
+		return MOTOR_DOWN;
+	}
+	return MOTOR_OFF;
+}
+
+static uint32_t takeCommand(void){
+	uint32_t goal;
+	if (xQueueReceive(cmdQueue, &goal, 0) == pdTRUE){
+		Goal = goal;
+		Target = directionTo(goal);
+	}
+	return Target;
+}
+
+// Auto travel runs as a job: the motor is started once and the task then
+// sleeps until a limit, jam or cancel event arrives, the target is reached
+// or the TIMEOUT_MOTION timer fires. A new command restarts the job towards its
+// target without stopping first.
+// Whenever the motor runs, manual or auto, the task also wakes every
+// PROFILE_PERIOD_MS to advance the position estimate and closure profile.
+static void motionTask(void *p){
+	(void)p;
+	uint32_t events;
+	travelLoad();
+	for(;;){
+		watchdogCheckIn(LIVE_MOTION);
+		BaseType_t notified = xTaskNotifyWait(0, UINT32_MAX, &events, profileWait());
+		profileStep();
+		if (notified == pdFALSE){
+			continue;
+		}
+		if (!(events & MOTION_START)){
+			continue;
+		}
+		
+		uint32_t reason = events & MOTION_STOP_EVENTS;
+		bool command = true;
+		while(reason == 0){
+			if (command){
+				command = false;
+				uint32_t dir = takeCommand();
+				if (dir == MOTOR_OFF){
+					reason = MOTION_TARGET;
+					break;
+				}
+				driveMotor(dir);
+				timeoutStart(TIMEOUT_MOTION, Config.motionTimeoutMs);
+			}
+			watchdogCheckIn(LIVE_MOTION);
+			notified = xTaskNotifyWait(0, UINT32_MAX, &events, profileWait());
+			profileStep();
+			uint32_t cap;
+			if (presetApproach(Goal, Target, &cap)){
+				reason = MOTION_TARGET;
+			}
+			Cap = cap;
+			if (notified == pdTRUE){
+				reason |= events & (MOTION_STOP_EVENTS | MOTION_TIMEOUT);
+				command = (events & MOTION_START) != 0;
+			}
+		}
+		
+		timeoutStop(TIMEOUT_MOTION);
+		// A jam hands the motor to jamHandler's reversal, which stops it
+		if (!(reason & MOTION_JAM)){
+			driveMotor(MOTOR_OFF);
+		}
+		Cap = 1000;
+		// Only this task clears Target and Active, and not while a
+		// MOTION_START is pending: that command has already set them for
+		// the job the next pass starts.
+		taskENTER_CRITICAL();
+		if (!(ulTaskNotifyValueClear(NULL, 0) & MOTION_START)){
+			Target = MOTOR_OFF;
+			Active = false;
+		}
+		taskEXIT_CRITICAL();
+		if (motionDone != NULL){
+			motionDone(reason);
+		}
+	}
+}
+
+// Timer service task: only flags the job, the motion task stops the motor
+static bool motionTimedOut(uint32_t id){
+	(void)id;
+	motionNotify(MOTION_TIMEOUT);
+	return true;
+}
+
+void motionInit(MotionDoneFn onDone){
+	motionDone = onDone;
+	timeoutSetup(TIMEOUT_MOTION, motionTimedOut, false);
+	closureInit();
+	cmdQueue = xQueueCreateStatic(1, sizeof(uint32_t), cmdQueueStorage, &cmdQueueBuffer);
+	motionHandle = xTaskCreateStatic(motionTask, "motion", 100, NULL, MOTION_PRIORITY, motionStack, &motionTcb);
+}
+
+// Targets in mid travel need a calibrated position, the ends do not
+bool motionGoto(uint32_t target){
+	if (!presetAtEnd(target) && !closureCalibrated()){
+		return false;
+	}
+	// Target, Active and the START bit change together, so the motion
+	// task's end-of-job check sees all of them or none
+	xQueueOverwrite(cmdQueue, &target);
+	taskENTER_CRITICAL();
+	Target = directionTo(target);
+	Active = true;
+	xTaskNotify(motionHandle, MOTION_START, eSetBits);
+	taskEXIT_CRITICAL();
+	return true;
+}
+
+void motionStart(uint32_t dir){
+	motionGoto(dir == MOTOR_UP ? POSITION_CLOSED : POSITION_OPEN);
+}
+
+void motionNotify(uint32_t events){
+	if (Active){
+		xTaskNotify(motionHandle, events, eSetBits);
+	}
+}
+
+void motionNotifyFromISR(uint32_t events, BaseType_t *woken){
+	if (Active){
+		xTaskNotifyFromISR(motionHandle, events, eSetBits, woken);
+	}
+}
+
+bool motionActive(void){
+	return Active;
+}
+
+uint32_t motionDirection(void){
+	return Target;
+}
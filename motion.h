@@ -0,0 +1,43 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+
+// Backstop only, a missed limit is caught as a stall. Covers an uncalibrated
+// close that runs the whole stroke at the pinch duty.
+#define MOTION_TIMEOUT_MS 12000
+#define MOTION_PRIORITY 2
+
+// Notification bits understood by the motion task
+#define MOTION_START   0x01U
+#define MOTION_LIMIT   0x02U
+#define MOTION_JAM     0x04U
+#define MOTION_CANCEL  0x08U
+#define MOTION_TIMEOUT 0x10U
+#define MOTION_STALL   0x20U
+#define MOTION_TARGET  0x40U
+
+#define MOTION_STOP_EVENTS (MOTION_LIMIT | MOTION_JAM | MOTION_CANCEL | MOTION_STALL)
+
+// Called from the motion task with the reason travel ended
+typedef void (*MotionDoneFn)(uint32_t reason);
+
+void motionInit(MotionDoneFn onDone);
+void motionStart(uint32_t dir);
+bool motionGoto(uint32_t target);
+void motionNotify(uint32_t events);
+void motionNotifyFromISR(uint32_t events, BaseType_t *woken);
+bool motionActive(void);
+uint32_t motionDirection(void);
+
+// Duty in per-mille of the MOTOR_PWM_HZ period
+#define MOTOR_PWM_HZ 20000
+
+void motorPwmInit(void);
+void motorSetDuty(uint32_t duty);
+uint32_t motorDuty(void);
+void driveMotor(uint32_t dir);
+
+#endif
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#include "gpio_fast.h"
+#include "motion.h"
+#include "clock.h"
+
+extern uint32_t SystemCoreClock;
+
+static uint32_t PwmLoad;
+static volatile uint32_t Duty;
+
+// PWM clock is SysClk / 2 (CFG_RCC_PWMDIV in system_TM4C123.c); also
+// runs on every clock switch to keep MOTOR_PWM_HZ and the duty
+static void pwmRederive(void){
+	PwmLoad = SystemCoreClock / 2 / MOTOR_PWM_HZ - 1;
+	PWM1_0_LOAD_R = PwmLoad;
+	motorSetDuty(Duty);
+}
+
+void motorPwmInit(void){
+	SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
+	while(!(SYSCTL_PRPWM_R & SYSCTL_PRPWM_R1));
+	
+	GPIO_PORTD_AFSEL_R |= PD_MOTOR;
+	GPIO_PORTD_PCTL_R = (GPIO_PORTD_PCTL_R & ~(GPIO_PCTL_PD0_M | GPIO_PCTL_PD1_M)) | GPIO_PCTL_PD0_M1PWM0 | GPIO_PCTL_PD1_M1PWM1;
+	GPIO_PORTD_DEN_R |= PD_MOTOR;
+	
+	PWM1_ENABLE_R = 0;
+	PWM1_0_CTL_R = 0;
+	PWM1_0_GENA_R = PWM_0_GENA_ACTCMPAD_ZERO | PWM_0_GENA_ACTLOAD_ONE;
+	PWM1_0_GENB_R = PWM_0_GENB_ACTCMPBD_ZERO | PWM_0_GENB_ACTLOAD_ONE;
+	pwmRederive();
+	motorSetDuty(1000);
+	PWM1_0_CTL_R = PWM_0_CTL_ENABLE;
+	clockSetup(CLOCK_PWM, pwmRederive);
+}
+
+void motorSetDuty(uint32_t duty){
+	Duty = duty;
+	uint32_t cmp = PwmLoad - (PwmLoad * duty) / 1000;
+	PWM1_0_CMPA_R = cmp;
+	PWM1_0_CMPB_R = cmp;
+}
+
+uint32_t motorDuty(void){
+	return Duty;
+}
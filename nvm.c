@@ -0,0 +1,27 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/eeprom.h>
+#include "nvm.h"
+
+static bool eepromReady;
+
+// EEPROM bring-up is kept off the boot path until the first access
+static void nvmInit(void){
+	if (!eepromReady){
+		SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+		while(!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0));
+		EEPROMInit();
+		eepromReady = true;
+	}
+}
+
+void nvmRead(uint32_t *data, uint32_t addr, uint32_t bytes){
+	nvmInit();
+	EEPROMRead(data, addr, bytes);
+}
+
+uint32_t nvmWrite(const uint32_t *data, uint32_t addr, uint32_t bytes){
+	nvmInit();
+	return EEPROMProgram((uint32_t *)data, addr, bytes);
+}
@@ -0,0 +1,16 @@
+#ifndef NVM_H
+#define NVM_H
+
+#include <stdint.h>
+
+// EEPROM map, byte addresses, word aligned
+//   0x000  configuration record slots (config.h)
+//   0x600  event log copy (EVENTLOG_EEPROM_ADDR)
+#define NVM_CONFIG_ADDR 0x000
+#define NVM_CONFIG_END  0x600
+
+// Both block for the EEPROM access time, call from task context only
+void nvmRead(uint32_t *data, uint32_t addr, uint32_t bytes);
+uint32_t nvmWrite(const uint32_t *data, uint32_t addr, uint32_t bytes);
+
+#endif
@@ -0,0 +1,28 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <driverlib/gpio.h>
+#include "gpio_fast.h"
+#include "pins.h"
+
+#define PIN_DESC(name, port, bit, pol, role, a) { FAST_PORT##port##_BASE, 1U << (bit), role, pol },
+
+static const struct PinDesc Pins[] = { PIN_TABLE(PIN_DESC, 0) };
+
+// Pad setup for every input in the table: direction, pull-up on active-low
+// pins and the edge for interrupt pins. Clock gates must already be open
+// (PINS_CLOCKS); enabling the interrupts is left to the caller so a pin's
+// consumer can be initialised first.
+void pinsInit(void){
+	for (uint32_t i = 0; i < sizeof(Pins) / sizeof(Pins[0]); i++){
+		const struct PinDesc *pin = &Pins[i];
+		if (!(pin->role & ROLE_INPUTS)) continue;
+
+		GPIOPinTypeGPIOInput(pin->base, pin->mask);
+		if (pin->activeLow)
+			*((volatile uint32_t *)(pin->base + FAST_GPIO_PUR)) |= pin->mask;
+		if (pin->role & ROLE_IRQ_FALL)
+			GPIOIntTypeSet(pin->base, pin->mask, GPIO_FALLING_EDGE);
+		else if (pin->role & ROLE_IRQ_BOTH)
+			GPIOIntTypeSet(pin->base, pin->mask, GPIO_BOTH_EDGES);
+	}
+}
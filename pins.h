@@ -0,0 +1,95 @@
+#ifndef PINS_H
+#define PINS_H
+
+#include <stdint.h>
+
+// Port ids are the RCGCGPIO/PRGPIO bit numbers
+#define PORT_A 0
+#define PORT_B 1
+#define PORT_C 2
+#define PORT_D 3
+#define PORT_E 4
+#define PORT_F 5
+
+#define ACTIVE_HIGH 0
+#define ACTIVE_LOW  1
+
+// What pinsInit() does with a pin. PWM and ANALOG pins are only claimed
+// here; their drivers (motorPwmInit, currentInit) set the alternate function.
+#define ROLE_INPUT    0x01U
+#define ROLE_IRQ_FALL 0x02U
+#define ROLE_IRQ_BOTH 0x04U
+#define ROLE_PWM      0x08U
+#define ROLE_ANALOG   0x10U
+#define ROLE_INPUTS   (ROLE_INPUT | ROLE_IRQ_FALL | ROLE_IRQ_BOTH)
+
+//////////////
+//	Pin map
+//////////////
+// One line per pin: X(name, port, bit, polarity, role, arg). Everything
+// else (masks, port groups, clock gates, pad setup) is generated from this
+// table, and the checks at the bottom reject a pin claimed twice.
+#define PIN_TABLE(X, a) \
+	X(LIMIT_CLOSED,   B, 0, ACTIVE_LOW,  ROLE_IRQ_BOTH, a) \
+	X(LIMIT_OPENED,   B, 1, ACTIVE_LOW,  ROLE_IRQ_BOTH, a) \
+	X(LOCK,           B, 4, ACTIVE_LOW,  ROLE_INPUT,    a) \
+	X(JAM,            B, 5, ACTIVE_LOW,  ROLE_IRQ_FALL, a) \
+	X(DRIVER_DOWN,    C, 5, ACTIVE_LOW,  ROLE_INPUT,    a) \
+	X(PASSENGER_UP,   C, 6, ACTIVE_LOW,  ROLE_INPUT,    a) \
+	X(MOTOR_UP,       D, 0, ACTIVE_HIGH, ROLE_PWM,      a) \
+	X(MOTOR_DOWN,     D, 1, ACTIVE_HIGH, ROLE_PWM,      a) \
+	X(DRIVER_UP,      D, 2, ACTIVE_LOW,  ROLE_INPUT,    a) \
+	X(PASSENGER_DOWN, D, 3, ACTIVE_LOW,  ROLE_INPUT,    a) \
+	X(CURRENT_SENSE,  E, 3, ACTIVE_HIGH, ROLE_ANALOG,   a) \
+	X(AUTO,           F, 4, ACTIVE_LOW,  ROLE_IRQ_FALL, a)
+
+// PIN_<name> is the pin mask, PIN_PORT_<name> the port id
+#define PIN_MASK_ENUM(name, port, bit, pol, role, a) PIN_##name = 1U << (bit),
+#define PIN_PORT_ENUM(name, port, bit, pol, role, a) PIN_PORT_##name = PORT_##port,
+enum PinMask { PIN_TABLE(PIN_MASK_ENUM, 0) };
+enum PinPort { PIN_TABLE(PIN_PORT_ENUM, 0) };
+
+// Constant expressions over the table, folded by the compiler
+#define PIN_OR_PORT(name, port, bit, pol, role, a) \
+	| ((PORT_##port == (a)) ? (1U << (bit)) : 0U)
+#define PIN_SUM_PORT(name, port, bit, pol, role, a) \
+	+ ((PORT_##port == (a)) ? (1U << (bit)) : 0U)
+#define PIN_OR_CLOCK(name, port, bit, pol, role, a) | (1U << PORT_##port)
+
+// Every pin of a port, and the pins of a port with any of the given roles
+#define PORT_PINS(p) (0U PIN_TABLE(PIN_OR_PORT, p))
+// (the port and roles travel through the table as one parenthesised arg)
+#define PORT_ROLE_PINS(p, roles) (0U PIN_TABLE(PIN_OR_ROLE, (p, roles)))
+#define PIN_OR_ROLE(name, port, bit, pol, role, pr) PIN_OR_ROLE_AT(port, bit, role, PIN_ARG_PORT pr, PIN_ARG_ROLES pr)
+#define PIN_OR_ROLE_AT(port, bit, role, p, r) | ((PORT_##port == (p) && ((role) & (r))) ? (1U << (bit)) : 0U)
+#define PIN_ARG_PORT(p, r) p
+#define PIN_ARG_ROLES(p, r) r
+
+// RCGCGPIO bits of every port the table touches
+#define PINS_CLOCKS (0U PIN_TABLE(PIN_OR_CLOCK, 0))
+
+// A pin claimed twice on one port makes the sum differ from the OR
+#define PIN_PORT_UNIQUE(p) ((0U PIN_TABLE(PIN_SUM_PORT, p)) == PORT_PINS(p))
+_Static_assert(PIN_PORT_UNIQUE(PORT_A), "pin used twice on port A");
+_Static_assert(PIN_PORT_UNIQUE(PORT_B), "pin used twice on port B");
+_Static_assert(PIN_PORT_UNIQUE(PORT_C), "pin used twice on port C");
+_Static_assert(PIN_PORT_UNIQUE(PORT_D), "pin used twice on port D");
+_Static_assert(PIN_PORT_UNIQUE(PORT_E), "pin used twice on port E");
+_Static_assert(PIN_PORT_UNIQUE(PORT_F), "pin used twice on port F");
+
+// PD7 and PF0 sit behind the GPIOLOCK/GPIOCR commit gate and pinsInit()
+// does not unlock them; PC0-PC3 are JTAG.
+_Static_assert(!(PORT_PINS(PORT_D) & 0x80U), "PD7 is locked (NMI)");
+_Static_assert(!(PORT_PINS(PORT_F) & 0x01U), "PF0 is locked (NMI)");
+_Static_assert(!(PORT_PINS(PORT_C) & 0x0FU), "PC0-PC3 are JTAG");
+
+struct PinDesc {
+	uint32_t base;
+	uint8_t mask;
+	uint8_t role;
+	uint8_t activeLow;
+};
+
+void pinsInit(void);
+
+#endif
@@ -0,0 +1,50 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio_fast.h"
+#include "closure.h"
+#include "preset.h"
+
+static uint32_t Targets[PRESETS] = PRESET_DEFAULTS;
+
+void presetConfigure(enum Preset preset, uint32_t position){
+	if (preset < PRESETS && position <= POSITION_CLOSED){
+		Targets[preset] = position;
+	}
+}
+
+uint32_t presetTarget(enum Preset preset){
+	return preset < PRESETS ? Targets[preset] : POSITION_OPEN;
+}
+
+// The end targets run into the limit switch rather than stop on the estimate
+bool presetAtEnd(uint32_t target){
+	return target == POSITION_OPEN || target == POSITION_CLOSED;
+}
+
+// Called every profile step while travelling towards target. Returns true
+// once the target is reached or passed, otherwise sets the duty cap for
+// the deceleration ramp.
+bool presetApproach(uint32_t target, uint32_t dir, uint32_t *dutyCap){
+	*dutyCap = 1000;
+	if (presetAtEnd(target)){
+		return false;
+	}
+	uint32_t pos = closurePosition();
+	uint32_t remaining;
+	if (dir == MOTOR_UP){
+		if (pos + TARGET_WINDOW >= target){
+			return true;
+		}
+		remaining = target - pos;
+	}
+	else {
+		if (pos <= target + TARGET_WINDOW){
+			return true;
+		}
+		remaining = pos - target;
+	}
+	if (remaining < DECEL_ZONE){
+		*dutyCap = DECEL_DUTY_MIN + (1000 - DECEL_DUTY_MIN) * remaining / DECEL_ZONE;
+	}
+	return false;
+}
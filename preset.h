@@ -0,0 +1,29 @@
+#ifndef PRESET_H
+#define PRESET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// One-touch targets in per-mille of travel (closure.h scale)
+enum Preset {
+	PRESET_OPEN,
+	PRESET_HALF,
+	PRESET_VENT,
+	PRESET_CLOSED,
+	PRESETS
+};
+
+#define PRESET_DEFAULTS {0, 500, 950, 1000}
+
+// Inside DECEL_ZONE of the target the duty ramps down to DECEL_DUTY_MIN,
+// travel stops once the estimate is within TARGET_WINDOW
+#define DECEL_ZONE     80
+#define DECEL_DUTY_MIN 300
+#define TARGET_WINDOW  3
+
+void presetConfigure(enum Preset preset, uint32_t position);
+uint32_t presetTarget(enum Preset preset);
+bool presetAtEnd(uint32_t target);
+bool presetApproach(uint32_t target, uint32_t dir, uint32_t *dutyCap);
+
+#endif
@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <driverlib/interrupt.h>
+#include <inc/hw_ints.h>
+#include "tm4c123gh6pm.h"
+#include "profile.h"
+#include "clock.h"
+
+#ifdef ENABLE_PROFILE
+
+extern uint32_t SystemCoreClock;
+
+struct ProfileLog ProfileLog;
+
+// Exception frame words: r0 r1 r2 r3 r12 lr pc xpsr
+#define FRAME_LR 5
+#define FRAME_PC 6
+
+void profileSample(uint32_t *frame, uint32_t excReturn);
+
+// Hands the interrupted context's frame to profileSample: EXC_RETURN bit 2
+// says whether it was stacked on the PSP (a task) or the MSP.
+__attribute__((naked)) static void profileInterrupt(void){
+	__asm volatile(
+		"mov   r1, lr      \n"
+		"tst   lr, #4      \n"
+		"ite   eq          \n"
+		"mrseq r0, msp     \n"
+		"mrsne r0, psp     \n"
+		"b     profileSample\n");
+}
+
+void profileSample(uint32_t *frame, uint32_t excReturn){
+	TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+	
+	uint32_t n = ProfileLog.count;
+	ProfileLog.samples[n].pc = frame[FRAME_PC];
+	ProfileLog.samples[n].lr = frame[FRAME_LR];
+	if (!(excReturn & 0x4U)){
+		ProfileLog.handler++;
+	}
+	if (++ProfileLog.count == PROFILE_SAMPLES){
+		profileStop();
+	}
+}
+
+static void profileRederive(void){
+	TIMER1_TAILR_R = SystemCoreClock / PROFILE_HZ - 1;
+}
+
+// Restarts the capture from an empty buffer, callable again from the
+// debugger (or code) once a dump has been saved.
+void profileStart(void){
+	SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+	while(!(SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R1));
+	
+	ProfileLog.magic = PROFILE_MAGIC;
+	ProfileLog.count = 0;
+	ProfileLog.handler = 0;
+	ProfileLog.rateHz = PROFILE_HZ;
+	
+	TIMER1_CTL_R = 0;
+	TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;
+	TIMER1_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+	profileRederive();
+	clockSetup(CLOCK_PROFILE, profileRederive);
+	TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+	TIMER1_IMR_R = TIMER_IMR_TATOIM;
+	
+	// Not isrRegister(): that one holds interrupts at or below the syscall ceiling
+	IntRegister(INT_TIMER1A, profileInterrupt);
+	IntPrioritySet(INT_TIMER1A, PROFILE_PRIORITY << (8 - configPRIO_BITS));
+	IntEnable(INT_TIMER1A);
+	TIMER1_CTL_R = TIMER_CTL_TAEN;
+}
+
+void profileStop(void){
+	TIMER1_CTL_R = 0;
+	TIMER1_IMR_R = 0;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// Statistical PC profiler, built with ENABLE_PROFILE. Timer 1A interrupts
+// at PROFILE_HZ and stores the interrupted context's stacked PC and LR
+// until PROFILE_SAMPLES are taken. Dump with
+//   SAVE prof.bin &ProfileLog, &ProfileLog + sizeof(ProfileLog)
+// and symbolise with tools/profile.py against Objects/Finalproject.axf.
+// With an SWO probe, the debugger's own DWT PC sampling (Trace > PC
+// Sampling) needs none of this; this path works on the bare ICDI.
+#define PROFILE_SAMPLES 512
+#define PROFILE_MAGIC 0x464F5250UL
+
+// Prime, so sampling never phase-locks to the 1 kHz tick or the 5/10 ms loops
+#define PROFILE_HZ 1009
+
+// Above the syscall ceiling so critical sections and the kernel's own
+// handlers are sampled too; the handler never touches the kernel.
+#define PROFILE_PRIORITY 1
+
+struct ProfileSample {
+	uint32_t pc;
+	uint32_t lr;
+};
+
+struct ProfileLog {
+	uint32_t magic;
+	uint32_t count;
+	uint32_t rateHz;
+	uint32_t handler;   // samples taken on the main stack (ISRs, pre-scheduler)
+	struct ProfileSample samples[PROFILE_SAMPLES];
+};
+
+#ifdef ENABLE_PROFILE
+extern struct ProfileLog ProfileLog;
+
+void profileStart(void);
+void profileStop(void);
+#else
+#define profileStart()
+#define profileStop()
+#endif
+
+#endif
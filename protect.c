@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "gpio_fast.h"
+#include "closure.h"
+#include "protect.h"
+
+#define MAX_STEP_MS 1000
+#define THERMAL_TRIP ((uint64_t)THERMAL_CONT_MA * THERMAL_CONT_MA * THERMAL_TAU_MS)
+
+volatile struct ProtectStats ProtectStats;
+
+static uint64_t Heat;          // mA^2 ms
+static bool Tripped;
+static uint32_t StalledDir = MOTOR_OFF;
+static uint32_t LastDir = MOTOR_OFF;
+static TickType_t LastStep;
+static uint32_t RunMs;
+static uint32_t OverMs;
+static uint32_t PinnedMs;
+
+static uint32_t heatPct(void){
+	return (uint32_t)(Heat * 100 / THERMAL_TRIP);
+}
+
+static bool thermalStep(uint32_t ma, uint32_t ms){
+	Heat += (uint64_t)ma * ma * ms;
+	Heat -= Heat * ms / THERMAL_TAU_MS;
+	
+	uint32_t pct = heatPct();
+	ProtectStats.heatPct = pct;
+	if (pct > ProtectStats.peakHeatPct){
+		ProtectStats.peakHeatPct = pct;
+	}
+	if (!Tripped && pct >= 100){
+		Tripped = true;
+		ProtectStats.trips++;
+		return true;
+	}
+	if (Tripped && pct <= THERMAL_RESUME_PCT){
+		Tripped = false;
+	}
+	return false;
+}
+
+// An uncalibrated estimate (after power-up or a reset) starts at the open
+// end whatever the glass is doing, so it is not evidence of an overrun
+static bool atEnd(uint32_t dir){
+	if (!closureCalibrated()){
+		return false;
+	}
+	uint32_t pos = closurePosition();
+	return (dir == MOTOR_UP && pos >= POSITION_CLOSED) || (dir == MOTOR_DOWN && pos <= POSITION_OPEN);
+}
+
+// Called every profile period with the motor current in the driven
+// direction. Returns the faults that fired on this step.
+uint32_t protectStep(uint32_t dir, uint32_t currentMa, TickType_t now){
+	uint32_t ms = (now - LastStep) * portTICK_PERIOD_MS;
+	LastStep = now;
+	if (ms > MAX_STEP_MS){
+		ms = MAX_STEP_MS;
+	}
+	
+	uint32_t faults = thermalStep(currentMa, ms) ? PROTECT_THERMAL : 0;
+	
+	if (dir != LastDir){
+		LastDir = dir;
+		RunMs = 0;
+		OverMs = 0;
+		PinnedMs = 0;
+		return faults;
+	}
+	if (dir == MOTOR_OFF){
+		return faults;
+	}
+	
+	RunMs += ms;
+	if (RunMs < INRUSH_BLANK_MS){
+		return faults;
+	}
+	
+	OverMs = currentMa > STALL_CURRENT_MA ? OverMs + ms : 0;
+	PinnedMs = atEnd(dir) ? PinnedMs + ms : 0;
+	
+	if (OverMs >= STALL_CURRENT_MS || PinnedMs >= STALL_OVERRUN_MS){
+		StalledDir = dir;
+		OverMs = 0;
+		PinnedMs = 0;
+		ProtectStats.stalls++;
+		faults |= PROTECT_STALL;
+	}
+	else if (dir == MOTOR_UP && currentMa > closureJamThreshold()){
+		ProtectStats.jams++;
+		faults |= PROTECT_JAM;
+	}
+	return faults;
+}
+
+uint32_t protectDutyLimit(void){
+	uint32_t pct = heatPct();
+	if (Tripped){
+		return 0;
+	}
+	if (pct <= THERMAL_DERATE_PCT){
+		return 1000;
+	}
+	if (pct >= 100){
+		return PROTECT_DUTY_MIN;
+	}
+	return 1000 - (1000 - PROTECT_DUTY_MIN) * (pct - THERMAL_DERATE_PCT) / (100 - THERMAL_DERATE_PCT);
+}
+
+// A stalled direction stays refused until the other way has been commanded,
+// so a held button cannot restart a motor that is pushing against a stop.
+bool protectPermit(uint32_t dir){
+	if (dir == MOTOR_OFF){
+		return true;
+	}
+	if (Tripped || dir == StalledDir){
+		return false;
+	}
+	StalledDir = MOTOR_OFF;
+	return true;
+}
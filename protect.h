@@ -0,0 +1,46 @@
+#ifndef PROTECT_H
+#define PROTECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+
+// Stall: current above STALL_CURRENT_MA for STALL_CURRENT_MS, or the
+// calibrated position estimate pinned at the end of travel while still
+// driving into it for STALL_OVERRUN_MS (a limit switch that never closed).
+#define STALL_CURRENT_MA 6000
+#define STALL_CURRENT_MS 300
+#define STALL_OVERRUN_MS 1000
+#define INRUSH_BLANK_MS  150
+
+// First-order I2t model: heat leaks with THERMAL_TAU_MS and trips at the
+// level THERMAL_CONT_MA would settle at, so that current can run forever.
+// Duty is derated linearly from THERMAL_DERATE_PCT down to PROTECT_DUTY_MIN
+// at the trip point; after a trip the motor stays blocked until the model
+// cools to THERMAL_RESUME_PCT.
+#define THERMAL_TAU_MS     60000
+#define THERMAL_CONT_MA    4000
+#define THERMAL_DERATE_PCT 70
+#define THERMAL_RESUME_PCT 50
+#define PROTECT_DUTY_MIN   300
+
+// protectStep() result bits
+#define PROTECT_STALL   0x01U
+#define PROTECT_JAM     0x02U
+#define PROTECT_THERMAL 0x04U
+
+struct ProtectStats {
+	uint32_t stalls;
+	uint32_t jams;
+	uint32_t trips;
+	uint32_t heatPct;
+	uint32_t peakHeatPct;
+};
+
+extern volatile struct ProtectStats ProtectStats;
+
+uint32_t protectStep(uint32_t dir, uint32_t currentMa, TickType_t now);
+uint32_t protectDutyLimit(void);
+bool protectPermit(uint32_t dir);
+
+#endif
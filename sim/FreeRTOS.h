@@ -0,0 +1,48 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+// Host kernel shim (sim/kernel.c): the part of the FreeRTOS 10.5 API the
+// firmware calls, with the values of RTE/RTOS/FreeRTOSConfig.h it reads.
+// The tick is 1 ms as on target.
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define configMAX_PRIORITIES 5
+#define configMINIMAL_STACK_SIZE ((uint16_t)256)
+#define configUSE_TIMERS 1
+#define configTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH 10
+#define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE / 2)
+#define configPRIO_BITS 3
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY 0x07
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+
+void simKernelAssert(const char *what, const char *file, int line);
+#define configASSERT(x) ((x) ? (void)0 : simKernelAssert(#x, __FILE__, __LINE__))
+
+// ISRs only run between kernel steps on the host, so there is nothing to mask
+#define portSET_INTERRUPT_MASK_FROM_ISR() 0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(mask) ((void)(mask))
+#define portEND_SWITCHING_ISR(woken) ((void)(woken))
+
+// The objects themselves live in kernel.c's pools; the static buffers the
+// firmware hands over only have to exist
+typedef struct { uint32_t unused; } StaticTask_t;
+typedef struct { uint32_t unused; } StaticQueue_t;
+typedef struct { uint32_t unused; } StaticTimer_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#endif
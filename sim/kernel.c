@@ -0,0 +1,618 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ucontext.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include "sim_hw.h"
+
+// Host stand-in for the FreeRTOS kernel, enough to run the firmware's
+// tasks unchanged. Tasks are ucontext coroutines on one thread: the
+// highest-priority ready task runs until it blocks, equal priorities take
+// turns, and a call that readies a higher-priority task switches to it at
+// once unless the caller is in a critical section or has the scheduler
+// suspended. Interrupts are the simulator calling the firmware's handlers
+// between kernel steps, so they never land mid-statement. Timers run in a
+// service task at configTIMER_TASK_PRIORITY behind a command queue of
+// configTIMER_QUEUE_LENGTH, as in timers.c.
+
+#define MAX_TASKS 8
+#define MAX_QUEUES 8
+#define MAX_TIMERS 8
+#define HOST_STACK_BYTES (64 * 1024)
+
+enum TaskState {
+	TASK_READY,
+	TASK_BLOCKED
+};
+
+enum NotifyState {
+	NOTIFY_NONE,
+	NOTIFY_WAITING,
+	NOTIFY_RECEIVED
+};
+
+struct SimTask {
+	ucontext_t context;
+	TaskFunction_t code;
+	void *param;
+	char name[16];
+	UBaseType_t priority;
+	UBaseType_t number;
+	enum TaskState state;
+	const void *waitingOn;   // queue or notification, NULL for a delay
+	bool timed;
+	TickType_t wakeAt;
+	uint32_t notifyValue;
+	enum NotifyState notify;
+	uint32_t lastRun;
+	uint8_t stack[HOST_STACK_BYTES];
+};
+
+struct SimQueue {
+	uint8_t *storage;
+	UBaseType_t length;
+	UBaseType_t itemSize;
+	UBaseType_t count;
+	UBaseType_t head;        // oldest item
+	struct SimQueue *set;
+};
+
+struct SimTimer {
+	TimerCallbackFunction_t callback;
+	void *id;
+	TickType_t period;
+	TickType_t expiry;
+	bool reload;
+	bool active;
+};
+
+enum TimerOp {
+	TIMER_CHANGE,
+	TIMER_STOP,
+	TIMER_PEND
+};
+
+struct TimerCommand {
+	enum TimerOp op;
+	struct SimTimer *timer;
+	TickType_t period;
+	PendedFunction_t function;
+	void *param1;
+	uint32_t param2;
+};
+
+// Deadline of one blocking call, fixed when the call is made
+struct Wait {
+	TickType_t until;
+	bool forever;
+	bool never;
+};
+
+static struct SimTask Tasks[MAX_TASKS];
+static uint32_t TaskCount;
+static struct SimQueue Queues[MAX_QUEUES];
+static uint32_t QueueCount;
+static struct SimTimer Timers[MAX_TIMERS];
+static uint32_t TimerCount;
+static struct TimerCommand Commands[configTIMER_QUEUE_LENGTH];
+static QueueHandle_t CommandQueue;
+
+static ucontext_t SchedulerContext;
+static struct SimTask *Running;
+static TickType_t Tick;
+static uint32_t Runs;
+static uint32_t Locked;         // critical section and suspend nesting
+static bool SwitchPending;
+static bool Started;
+static bool TickUsed;
+
+void simKernelAssert(const char *what, const char *file, int line){
+	fprintf(stderr, "assertion failed: %s (%s:%d)\n", what, file, line);
+	abort();
+}
+
+static void taskEntry(void){
+	Running->code(Running->param);
+	simKernelAssert("task returned", __FILE__, __LINE__);
+}
+
+// Back to simKernelRun; the task carries on from here when next picked
+static void suspendRunning(void){
+	swapcontext(&Running->context, &SchedulerContext);
+}
+
+static void preempt(bool higher){
+	if (!higher || Running == NULL){
+		return;
+	}
+	if (Locked != 0){
+		SwitchPending = true;
+		return;
+	}
+	suspendRunning();
+}
+
+// Readies every task blocked on object, true if one outranks the caller
+static bool release(const void *object){
+	bool higher = false;
+	for(uint32_t i = 0; i < TaskCount; i++){
+		struct SimTask *t = &Tasks[i];
+		if (t->state == TASK_BLOCKED && t->waitingOn == object && object != NULL){
+			t->state = TASK_READY;
+			t->waitingOn = NULL;
+			t->timed = false;
+			higher |= Running == NULL || t->priority > Running->priority;
+		}
+	}
+	return higher;
+}
+
+static struct Wait waitFor(TickType_t ticks){
+	struct Wait w = {Tick + ticks, ticks == portMAX_DELAY, ticks == 0};
+	return w;
+}
+
+// Blocks the running task on object until it is released or the deadline
+// passes. False means the caller must give up: no wait was asked for, the
+// deadline has passed, or there is no task to block (boot, ISRs).
+static bool block(const void *object, const struct Wait *w){
+	if (Running == NULL || w->never || (!w->forever && (int32_t)(w->until - Tick) <= 0)){
+		return false;
+	}
+	configASSERT(Locked == 0);
+	Running->state = TASK_BLOCKED;
+	Running->waitingOn = object;
+	Running->timed = !w->forever;
+	Running->wakeAt = w->until;
+	suspendRunning();
+	return true;
+}
+
+static struct SimTask *pick(void){
+	struct SimTask *best = NULL;
+	for(uint32_t i = 0; i < TaskCount; i++){
+		struct SimTask *t = &Tasks[i];
+		if (t->state != TASK_READY){
+			continue;
+		}
+		if (best == NULL || t->priority > best->priority ||
+		    (t->priority == best->priority && t->lastRun < best->lastRun)){
+			best = t;
+		}
+	}
+	return best;
+}
+
+//////////////
+//	Simulator side
+//////////////
+
+// One tick: delays and timed waits that are due become ready
+void simKernelTick(void){
+	Tick++;
+	for(uint32_t i = 0; i < TaskCount; i++){
+		struct SimTask *t = &Tasks[i];
+		if (t->state == TASK_BLOCKED && t->timed && (int32_t)(Tick - t->wakeAt) >= 0){
+			t->state = TASK_READY;
+			t->waitingOn = NULL;
+			t->timed = false;
+		}
+	}
+}
+
+// Runs tasks until all are blocked or one has spent the tick busy
+void simKernelRun(void){
+	if (!Started){
+		return;
+	}
+	TickUsed = false;
+	while(!TickUsed){
+		struct SimTask *t = pick();
+		if (t == NULL){
+			return;
+		}
+		t->lastRun = ++Runs;
+		Running = t;
+		swapcontext(&SchedulerContext, &t->context);
+		Running = NULL;
+	}
+}
+
+//////////////
+//	Tasks
+//////////////
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t code, const char *name, uint32_t depth, void *param,
+                               UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb){
+	(void)depth;
+	(void)stack;
+	(void)tcb;
+	configASSERT(TaskCount < MAX_TASKS);
+	configASSERT(priority < configMAX_PRIORITIES);
+	struct SimTask *t = &Tasks[TaskCount++];
+	t->code = code;
+	t->param = param;
+	snprintf(t->name, sizeof(t->name), "%s", name);
+	t->priority = priority;
+	t->state = TASK_READY;
+	getcontext(&t->context);
+	t->context.uc_stack.ss_sp = t->stack;
+	t->context.uc_stack.ss_size = sizeof(t->stack);
+	t->context.uc_link = NULL;
+	makecontext(&t->context, taskEntry, 0);
+	preempt(Started && Running != NULL && priority > Running->priority);
+	return t;
+}
+
+static void timerService(void *p);
+
+void vTaskStartScheduler(void){
+	static StaticTask_t timerTcb;
+	xTaskCreateStatic(timerService, "Tmr Svc", configTIMER_TASK_STACK_DEPTH, NULL, configTIMER_TASK_PRIORITY, NULL, &timerTcb);
+	Started = true;
+}
+
+BaseType_t xTaskGetSchedulerState(void){
+	if (!Started){
+		return taskSCHEDULER_NOT_STARTED;
+	}
+	return Locked != 0 ? taskSCHEDULER_SUSPENDED : taskSCHEDULER_RUNNING;
+}
+
+void simCriticalEnter(void){
+	Locked++;
+}
+
+void simCriticalExit(void){
+	configASSERT(Locked != 0);
+	if (--Locked == 0 && SwitchPending){
+		SwitchPending = false;
+		preempt(true);
+	}
+}
+
+void vTaskSuspendAll(void){
+	simCriticalEnter();
+}
+
+BaseType_t xTaskResumeAll(void){
+	bool pending = SwitchPending;
+	simCriticalExit();
+	return pending && Locked == 0 ? pdTRUE : pdFALSE;
+}
+
+// A busy task: it keeps the CPU for the rest of the tick but stays ready
+void simTaskYield(void){
+	if (Running != NULL){
+		TickUsed = true;
+		suspendRunning();
+	}
+}
+
+void vTaskDelay(TickType_t ticks){
+	struct Wait w = waitFor(ticks);
+	while(block(NULL, &w));
+}
+
+void vTaskDelayUntil(TickType_t *previous, TickType_t increment){
+	TickType_t wake = *previous + increment;
+	*previous = wake;
+	if ((int32_t)(wake - Tick) > 0){
+		vTaskDelay(wake - Tick);
+	}
+}
+
+TickType_t xTaskGetTickCount(void){
+	return Tick;
+}
+
+TickType_t xTaskGetTickCountFromISR(void){
+	return Tick;
+}
+
+char *pcTaskGetName(TaskHandle_t task){
+	return (task != NULL ? task : Running)->name;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task){
+	return (task != NULL ? task : Running)->priority;
+}
+
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t task){
+	return task != NULL ? task->number : 0;
+}
+
+void vTaskSetTaskNumber(TaskHandle_t task, UBaseType_t number){
+	if (task != NULL){
+		task->number = number;
+	}
+}
+
+//////////////
+//	Notifications
+//////////////
+
+static bool notify(struct SimTask *t, uint32_t value, eNotifyAction action){
+	if (action == eSetBits){
+		t->notifyValue |= value;
+	}
+	enum NotifyState was = t->notify;
+	t->notify = NOTIFY_RECEIVED;
+	return was == NOTIFY_WAITING && release(&t->notify);
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action){
+	preempt(notify(task, value, action));
+	return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *woken){
+	if (notify(task, value, action) && woken != NULL){
+		*woken = pdTRUE;
+	}
+	return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value, TickType_t ticks){
+	struct SimTask *self = Running;
+	configASSERT(self != NULL);
+	if (self->notify != NOTIFY_RECEIVED){
+		self->notifyValue &= ~clearOnEntry;
+		self->notify = NOTIFY_WAITING;
+		struct Wait w = waitFor(ticks);
+		while(self->notify != NOTIFY_RECEIVED && block(&self->notify, &w));
+	}
+	if (value != NULL){
+		*value = self->notifyValue;
+	}
+	BaseType_t received = self->notify == NOTIFY_RECEIVED ? pdTRUE : pdFALSE;
+	if (received){
+		self->notifyValue &= ~clearOnExit;
+	}
+	self->notify = NOTIFY_NONE;
+	return received;
+}
+
+uint32_t ulTaskNotifyValueClear(TaskHandle_t task, uint32_t clear){
+	struct SimTask *t = task != NULL ? task : Running;
+	uint32_t value = t->notifyValue;
+	t->notifyValue &= ~clear;
+	return value;
+}
+
+//////////////
+//	Queues, sets and semaphores
+//////////////
+
+QueueHandle_t xQueueGenericCreateStatic(UBaseType_t length, UBaseType_t itemSize, uint8_t *storage,
+                                        StaticQueue_t *buffer, uint8_t type){
+	(void)buffer;
+	(void)type;
+	configASSERT(QueueCount < MAX_QUEUES);
+	configASSERT(itemSize == 0 || storage != NULL);
+	struct SimQueue *q = &Queues[QueueCount++];
+	q->storage = storage;
+	q->length = length;
+	q->itemSize = itemSize;
+	return q;
+}
+
+static void put(struct SimQueue *q, const void *item){
+	if (q->itemSize != 0){
+		memcpy(&q->storage[((q->head + q->count) % q->length) * q->itemSize], item, q->itemSize);
+	}
+	q->count++;
+}
+
+static void take(struct SimQueue *q, void *item){
+	if (q->itemSize != 0){
+		memcpy(item, &q->storage[q->head * q->itemSize], q->itemSize);
+	}
+	q->head = (q->head + 1) % q->length;
+	q->count--;
+}
+
+
+// Waits for room unless overwriting. A member that gains an item posts
+// its handle to the set, except when the item replaced one the set has
+// already been told about.
+static BaseType_t send(struct SimQueue *q, const void *item, TickType_t ticks, bool overwrite, bool *higher){
+	struct Wait w = waitFor(ticks);
+	*higher = false;
+	while(q->count == q->length && !overwrite){
+		if (!block(q, &w)){
+			return pdFAIL;
+		}
+	}
+	bool replaced = q->count == q->length;
+	if (replaced){
+		q->count = 0;
+	}
+	put(q, item);
+	*higher = release(q);
+	if (q->set != NULL && !replaced){
+		configASSERT(q->set->count < q->set->length);
+		put(q->set, &q);
+		*higher |= release(q->set);
+	}
+	return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks){
+	bool higher;
+	BaseType_t sent = send(queue, item, ticks, false, &higher);
+	preempt(higher);
+	return sent;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken){
+	bool higher;
+	BaseType_t sent = send(queue, item, 0, false, &higher);
+	if (higher && woken != NULL){
+		*woken = pdTRUE;
+	}
+	return sent;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item){
+	configASSERT(queue->length == 1);
+	bool higher;
+	BaseType_t sent = send(queue, item, 0, true, &higher);
+	preempt(higher);
+	return sent;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks){
+	struct Wait w = waitFor(ticks);
+	while(queue->count == 0){
+		if (!block(queue, &w)){
+			return pdFALSE;
+		}
+	}
+	take(queue, item);
+	preempt(release(queue));
+	return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue){
+	return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue){
+	return queue->length - queue->count;
+}
+
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set){
+	if (member->set != NULL || member->count != 0){
+		return pdFAIL;
+	}
+	member->set = set;
+	return pdPASS;
+}
+
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t ticks){
+	QueueSetMemberHandle_t member = NULL;
+	xQueueReceive(set, &member, ticks);
+	return member;
+}
+
+//////////////
+//	Software timers
+//////////////
+
+static void timerCommandsInit(void){
+	if (CommandQueue == NULL){
+		CommandQueue = xQueueCreateStatic(configTIMER_QUEUE_LENGTH, sizeof(struct TimerCommand), (uint8_t *)Commands, NULL);
+	}
+}
+
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t autoReload, void *id,
+                                 TimerCallbackFunction_t callback, StaticTimer_t *buffer){
+	(void)name;
+	(void)buffer;
+	configASSERT(TimerCount < MAX_TIMERS);
+	timerCommandsInit();
+	struct SimTimer *t = &Timers[TimerCount++];
+	t->callback = callback;
+	t->id = id;
+	t->period = period;
+	t->reload = autoReload != pdFALSE;
+	return t;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer){
+	return timer->id;
+}
+
+void vTimerSetReloadMode(TimerHandle_t timer, UBaseType_t autoReload){
+	timer->reload = autoReload != pdFALSE;
+}
+
+static BaseType_t timerCommand(const struct TimerCommand *cmd, TickType_t ticks){
+	return xQueueSend(CommandQueue, cmd, ticks);
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks){
+	struct TimerCommand cmd = {TIMER_CHANGE, timer, period, NULL, NULL, 0};
+	return timerCommand(&cmd, ticks);
+}
+
+BaseType_t xTimerChangePeriodFromISR(TimerHandle_t timer, TickType_t period, BaseType_t *woken){
+	struct TimerCommand cmd = {TIMER_CHANGE, timer, period, NULL, NULL, 0};
+	return xQueueSendFromISR(CommandQueue, &cmd, woken);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks){
+	struct TimerCommand cmd = {TIMER_STOP, timer, 0, NULL, NULL, 0};
+	return timerCommand(&cmd, ticks);
+}
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t function, void *param1, uint32_t param2, TickType_t ticks){
+	struct TimerCommand cmd = {TIMER_PEND, NULL, 0, function, param1, param2};
+	return timerCommand(&cmd, ticks);
+}
+
+// Calls back every timer that is due, returns the ticks to the next one
+static TickType_t fireExpired(void){
+	for(;;){
+		struct SimTimer *due = NULL;
+		for(uint32_t i = 0; i < TimerCount; i++){
+			struct SimTimer *t = &Timers[i];
+			if (t->active && (int32_t)(Tick - t->expiry) >= 0 && (due == NULL || (int32_t)(t->expiry - due->expiry) < 0)){
+				due = t;
+			}
+		}
+		if (due == NULL){
+			break;
+		}
+		if (due->reload){
+			due->expiry += due->period;
+		}
+		else {
+			due->active = false;
+		}
+		due->callback(due);
+	}
+	TickType_t wait = portMAX_DELAY;
+	for(uint32_t i = 0; i < TimerCount; i++){
+		if (Timers[i].active && Timers[i].expiry - Tick < wait){
+			wait = Timers[i].expiry - Tick;
+		}
+	}
+	return wait;
+}
+
+static void applyCommand(const struct TimerCommand *cmd){
+	switch(cmd->op){
+		case TIMER_CHANGE:
+			cmd->timer->period = cmd->period;
+			cmd->timer->expiry = Tick + cmd->period;
+			cmd->timer->active = true;
+			break;
+		case TIMER_STOP:
+			cmd->timer->active = false;
+			break;
+		case TIMER_PEND:
+			cmd->function(cmd->param1, cmd->param2);
+			break;
+	}
+}
+
+// prvTimerTask: expiries first, then the commands queued meanwhile
+static void timerService(void *p){
+	(void)p;
+	struct TimerCommand cmd;
+	for(;;){
+		TickType_t wait = fireExpired();
+		if (xQueueReceive(CommandQueue, &cmd, wait) == pdTRUE){
+			applyCommand(&cmd);
+			while(xQueueReceive(CommandQueue, &cmd, 0) == pdTRUE){
+				applyCommand(&cmd);
+			}
+		}
+	}
+}
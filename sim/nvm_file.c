@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "nvm.h"
+#include "sim_hw.h"
+
+// Host backend for nvm.h: a RAM image of the 2 KB EEPROM, loaded from and
+// written through to a file so learned values survive between runs (and,
+// being outside the MCU, a reset).
+#define EEPROM_BYTES 2048
+
+static uint8_t Image[EEPROM_BYTES] SIM_WORLD;
+static const char *Path SIM_WORLD;
+
+void simNvmOpen(const char *path){
+	memset(Image, 0xFF, sizeof(Image));
+	Path = path;
+	FILE *f = fopen(path, "rb");
+	if (f){
+		size_t n = fread(Image, 1, sizeof(Image), f);
+		(void)n;
+		fclose(f);
+	}
+}
+
+void nvmRead(uint32_t *data, uint32_t addr, uint32_t bytes){
+	if (addr + bytes > EEPROM_BYTES){
+		memset(data, 0xFF, bytes);
+		return;
+	}
+	memcpy(data, &Image[addr], bytes);
+}
+
+uint32_t nvmWrite(const uint32_t *data, uint32_t addr, uint32_t bytes){
+	if (addr + bytes > EEPROM_BYTES){
+		return 1;
+	}
+	memcpy(&Image[addr], data, bytes);
+	if (Path){
+		FILE *f = fopen(Path, "wb");
+		if (!f){
+			return 1;
+		}
+		fwrite(Image, 1, sizeof(Image), f);
+		fclose(f);
+	}
+	return 0;
+}
@@ -0,0 +1,64 @@
+#include <math.h>
+#include "plant.h"
+
+#define GRAVITY 9.81
+
+void plantInit(struct PlantState *s, double position){
+	s->position = position;
+	s->velocity = 0;
+	s->current = 0;
+	s->obstacleForce = 0;
+	s->sealForce = 0;
+}
+
+// Semi-implicit Euler; dt must stay well below L/R (1.5 ms with the defaults)
+void plantStep(struct PlantState *s, const struct PlantParams *p, double voltage, double dt){
+	double toMotor = p->gearRatio / p->drumRadius;      // rad/s of motor per m/s of glass
+	double omega = s->velocity * toMotor;
+	
+	double di = (voltage - p->resistance * s->current - p->kt * omega) / p->inductance;
+	s->current += di * dt;
+	
+	double drive = p->kt * s->current * toMotor * p->efficiency;
+	
+	s->sealForce = s->position > p->sealStart ? (s->position - p->sealStart) * p->sealStiffness : 0;
+	s->obstacleForce = (p->obstacle > 0 && s->position > p->obstacle) ? (s->position - p->obstacle) * p->obstacleStiffness : 0;
+	
+	double mass = p->mass + p->rotorInertia * toMotor * toMotor;
+	double load = p->mass * GRAVITY + s->sealForce + s->obstacleForce + p->viscous * s->velocity;
+	double net = drive - load;
+	
+	// Stiction: the glass stays put until the drive beats static friction.
+	// The worm stage does not back-drive, so an unpowered glass never moves.
+	if (s->velocity == 0 && (voltage == 0 || fabs(net) <= p->friction)){
+		net = 0;
+	}
+	else {
+		double dir = s->velocity != 0 ? s->velocity : net;
+		net -= dir > 0 ? p->friction : -p->friction;
+	}
+	
+	double v = s->velocity + net / mass * dt;
+	if (s->velocity != 0 && (v > 0) != (s->velocity > 0)){
+		v = 0;
+	}
+	s->velocity = v;
+	s->position += v * dt;
+	
+	if (s->position <= 0){
+		s->position = 0;
+		s->velocity = 0;
+	}
+	else if (s->position >= p->travel){
+		s->position = p->travel;
+		s->velocity = 0;
+	}
+}
+
+bool plantLimitOpened(const struct PlantState *s, const struct PlantParams *p){
+	return s->position <= p->limitOpened;
+}
+
+bool plantLimitClosed(const struct PlantState *s, const struct PlantParams *p){
+	return s->position >= p->limitClosed;
+}
@@ -0,0 +1,49 @@
+#ifndef PLANT_H
+#define PLANT_H
+
+#include <stdbool.h>
+
+// Lumped model of the door module: permanent magnet DC motor, worm gearbox,
+// cable drum and glass. Positions are metres of glass travel from fully open,
+// forces are at the glass. Units are SI throughout.
+struct PlantParams {
+	double supply;        // V at the H-bridge
+	double resistance;    // armature, ohm
+	double inductance;    // armature, H
+	double kt;            // torque and back-EMF constant, Nm/A = Vs/rad
+	double rotorInertia;  // kg m^2, dominates the moving mass once reflected
+	double gearRatio;     // motor turns per drum turn
+	double drumRadius;    // m
+	double efficiency;    // gearbox
+	double mass;          // glass and carrier, kg
+	double friction;      // Coulomb friction in the run channel, N
+	double viscous;       // N per m/s
+	double travel;        // m, open to hard stop
+	double sealStart;     // m, where the top seal starts loading the glass
+	double sealStiffness; // N/m
+	double limitOpened;   // m, switch closes at or below
+	double limitClosed;   // m, switch closes at or above
+	double obstacle;      // m, 0 = none
+	double obstacleStiffness; // N/m, 10 N/mm per the pinch test rod
+};
+
+struct PlantState {
+	double position;
+	double velocity;
+	double current;
+	double obstacleForce;
+	double sealForce;
+};
+
+#define PLANT_PARAMS_DEFAULT { \
+	12.0, 0.8, 0.0012, 0.025, 5e-6, 56.0, 0.012, 0.6, \
+	1.2, 25.0, 40.0, 0.40, 0.385, 4000.0, \
+	0.002, 0.398, 0.0, 10000.0 }
+
+void plantInit(struct PlantState *s, double position);
+// voltage is signed, positive closes
+void plantStep(struct PlantState *s, const struct PlantParams *p, double voltage, double dt);
+bool plantLimitOpened(const struct PlantState *s, const struct PlantParams *p);
+bool plantLimitClosed(const struct PlantState *s, const struct PlantParams *p);
+
+#endif
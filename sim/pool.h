@@ -0,0 +1,78 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Lock-free fixed-block pool. Free blocks form a LIFO list threaded
+// through a next-index array; head packs a 16-bit tag above the top index
+// and every push and pop bumps the tag, so a compare-exchange that raced
+// with a pop/push pair of the same block (ABA) fails and retries. Alloc
+// and free are O(1), never mask interrupts and are safe from any ISR.
+// Host only for now: every firmware message goes by value through a static
+// queue, so nothing on the target allocates at runtime.
+#define POOL_NIL 0xFFFFU
+#define POOL_TAG 0x10000UL
+
+struct Pool {
+	volatile uint32_t head;
+	volatile uint32_t used;
+	volatile uint32_t highWater;
+	volatile uint32_t failures;
+	uint16_t count;
+	uint16_t blockSize;
+	uint16_t *next;
+	uint8_t *blocks;
+};
+
+// Blocks are type-sized and type-aligned; call poolInit once before use
+#define POOL_DEFINE(name, type, n) \
+	_Static_assert((n) > 0 && (n) < POOL_NIL, #name " needs 1..65534 blocks"); \
+	static type name##Blocks[n]; \
+	static uint16_t name##Next[n]; \
+	static struct Pool name = {POOL_NIL, 0, 0, 0, (n), sizeof(type), name##Next, (uint8_t *)name##Blocks}
+
+static inline void poolInit(struct Pool *p){
+	for(uint32_t i = 0; i < p->count; i++){
+		p->next[i] = (uint16_t)(i + 1 < p->count ? i + 1 : POOL_NIL);
+	}
+	p->used = 0;
+	p->highWater = 0;
+	p->failures = 0;
+	__atomic_store_n(&p->head, 0, __ATOMIC_RELEASE);
+}
+
+// Returns NULL when the pool is empty, counted in failures
+static inline void *poolAlloc(struct Pool *p){
+	uint32_t head = __atomic_load_n(&p->head, __ATOMIC_ACQUIRE);
+	uint32_t index;
+	for(;;){
+		index = head & POOL_NIL;
+		if (index == POOL_NIL){
+			__atomic_add_fetch(&p->failures, 1, __ATOMIC_RELAXED);
+			return NULL;
+		}
+		uint32_t next = ((head + POOL_TAG) & ~(uint32_t)POOL_NIL) | p->next[index];
+		if (__atomic_compare_exchange_n(&p->head, &head, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+			break;
+		}
+	}
+
+	uint32_t used = __atomic_add_fetch(&p->used, 1, __ATOMIC_RELAXED);
+	uint32_t high = p->highWater;
+	while (used > high && !__atomic_compare_exchange_n(&p->highWater, &high, used, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	return &p->blocks[index * p->blockSize];
+}
+
+static inline void poolFree(struct Pool *p, void *block){
+	uint32_t index = (uint32_t)((uint8_t *)block - p->blocks) / p->blockSize;
+	uint32_t head = __atomic_load_n(&p->head, __ATOMIC_RELAXED);
+	uint32_t next;
+	do {
+		p->next[index] = (uint16_t)(head & POOL_NIL);
+		next = ((head + POOL_TAG) & ~(uint32_t)POOL_NIL) | index;
+	} while (!__atomic_compare_exchange_n(&p->head, &head, next, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	__atomic_sub_fetch(&p->used, 1, __ATOMIC_RELAXED);
+}
+
+#endif
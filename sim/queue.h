@@ -0,0 +1,29 @@
+#ifndef SIM_QUEUE_H
+#define SIM_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct SimQueue *QueueHandle_t;
+typedef struct SimQueue *QueueSetHandle_t;
+typedef struct SimQueue *QueueSetMemberHandle_t;
+
+#define queueQUEUE_TYPE_BASE 0
+#define queueQUEUE_TYPE_SET 0
+#define queueQUEUE_TYPE_BINARY_SEMAPHORE 3
+
+QueueHandle_t xQueueGenericCreateStatic(UBaseType_t length, UBaseType_t itemSize, uint8_t *storage,
+                                        StaticQueue_t *buffer, uint8_t type);
+#define xQueueCreateStatic(length, itemSize, storage, buffer) \
+	xQueueGenericCreateStatic((length), (itemSize), (storage), (buffer), queueQUEUE_TYPE_BASE)
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken);
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set);
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t ticks);
+
+#endif
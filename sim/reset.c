@@ -0,0 +1,41 @@
+#include <stdlib.h>
+#include <string.h>
+#include "watchdog.h"
+#include "boot.h"
+#include "sim_hw.h"
+
+// MCU reset for the host build. simResetInit() keeps a copy of the
+// program's data and bss as loaded and simReset() writes it back, which
+// is what a reset and the C library's scatter-load do to the firmware's
+// RAM: tasks, queues, timers and every static start over. The sim_world
+// section and the watchdog's retained block (the NoInit region on target)
+// are carried across.
+
+extern char __data_start[];
+extern char _end[];
+extern char __start_sim_world[];
+extern char __stop_sim_world[];
+
+static char *Image SIM_WORLD;
+
+void simResetInit(void){
+	size_t bytes = (size_t)(_end - __data_start);
+	Image = malloc(bytes);
+	memcpy(Image, __data_start, bytes);
+}
+
+void simReset(void){
+	size_t bytes = (size_t)(__stop_sim_world - __start_sim_world);
+	char *world = malloc(bytes);
+	memcpy(world, __start_sim_world, bytes);
+	struct Retained retained = Retained;
+	
+	memcpy(__data_start, Image, (size_t)(_end - __data_start));
+	// The compiler cannot see that the copy above overlaps Retained and
+	// sim_world, and would otherwise drop the writes below as redundant
+	__asm__ volatile("" ::: "memory");
+	
+	memcpy(__start_sim_world, world, bytes);
+	Retained = retained;
+	free(world);
+}
@@ -0,0 +1,15 @@
+#ifndef SIM_SEMPHR_H
+#define SIM_SEMPHR_H
+
+#include "queue.h"
+
+// Binary semaphores are one-slot queues of zero-size items, as in queue.c
+typedef QueueHandle_t SemaphoreHandle_t;
+
+#define xSemaphoreCreateBinaryStatic(buffer) \
+	xQueueGenericCreateStatic(1, 0, NULL, (buffer), queueQUEUE_TYPE_BINARY_SEMAPHORE)
+#define xSemaphoreGive(sem) xQueueSend((sem), NULL, 0)
+#define xSemaphoreGiveFromISR(sem, woken) xQueueSendFromISR((sem), NULL, (woken))
+#define xSemaphoreTake(sem, ticks) xQueueReceive((sem), NULL, (ticks))
+
+#endif
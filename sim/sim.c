@@ -0,0 +1,460 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "gpio_fast.h"
+#include "inputs.h"
+#include "eventlog.h"
+#include "window.h"
+#include "watchdog.h"
+#include "boot.h"
+#include "motion.h"
+#include "closure.h"
+#include "protect.h"
+#include "preset.h"
+#include "config.h"
+#include "clock.h"
+#include "plant.h"
+#include "sim_hw.h"
+
+// Closed-loop host run of the window firmware against the plant model.
+//
+// The firmware runs as built for the target: main.c's tasks, the motion
+// task, limits, deferred ISR work, timers and the watchdog supervisor, on
+// the kernel shim in sim/kernel.c. The simulator only plays the hardware:
+// it sets pin levels, calls the port B and port F handlers on their edges,
+// ticks the kernel every 1 ms, steps the plant at SIM_DT from the PWM
+// outputs, and resets the firmware when WDT0 fires (sim/reset.c).
+//
+// Inputs come either from a replay stream (tools/eventlog_replay.py output)
+// or from scripted button taps. Summary metrics are printed as key=value for diffing builds.
+//
+//   cc -O2 -DSIMULATOR -Isim -I. sim/*.c main.c motion.c limits.c isr.c timeouts.c watchdog.c window.c inputs.c eventlog.c boot.c closure.c protect.c preset.c config.c gesture.c -lm -lpthread -o window-sim
+//   ./window-sim --profile prof.txt && python3 tools/profile.py prof.txt window-sim
+//   python3 tools/eventlog_replay.py dump.bin > run.txt && ./window-sim --replay run.txt
+//   python3 tools/sim_check.py --sim ./window-sim
+
+#define SIM_DT        50e-6
+#define TICK_STEPS    20      // 1 ms tick
+#define TAP_MS        100     // well inside GESTURE_HOLD_MS
+#define SETTLE_MS     20      // a few input scans for the tap to take
+#define CYCLE_S       20      // default run per cycle: an unlearned close at pinch duty (~11 s) and an open
+#define MAX_GOTOS 8
+#define GOTO_REJECTED 100000
+
+// main.c entry points the simulator drives
+int firmwareMain(void);
+void portBInterrupt(void);
+void autoModeInterrupt(void);
+void postWindowMsg(enum WindowMsgType type, uint32_t arg, uint32_t value);
+
+struct Replay {
+	FILE *f;
+	double nextUs;
+	uint32_t nextPin;
+	uint32_t nextValue;
+	uint32_t nextWord;
+	bool done;
+};
+
+// Preset request issued at a given time: PRESET_HALF is set to the target
+// and a MSG_PRESET posted, as a remote or diagnostic request would
+struct Goto {
+	uint32_t target;
+	uint32_t at;
+	double stopMs;
+	int error;
+};
+
+// Scripted one-touch strokes: tap the driver's switch, wait for the job
+enum StrokeState {
+	STROKE_IDLE,
+	STROKE_PRESSED,
+	STROKE_RUNNING
+};
+
+struct Strokes {
+	enum StrokeState state;
+	uint32_t button;
+	uint32_t left;
+	uint32_t at;
+};
+
+// Sim time of the first jam (jam input or current), the reversal it
+// started and the glass travel during it
+struct JamRun {
+	double at;
+	double startMs;
+	double endMs;
+	double startPos;
+	double mm;
+};
+
+// Injected input task hang, the WDT0 reset it ends in and the first input
+// scan of the restarted firmware
+struct Recovery {
+	double hangMs;
+	double resetMs;
+	double responsiveMs;
+	uint32_t resets;
+	uint32_t scans;
+};
+
+struct Metrics {
+	double startMs;
+	double closedMs;
+	double peakPinchN;
+	double pinchMs;
+	double peakCurrent;
+	double blockedMs;
+	uint32_t strokes;
+	uint32_t travelWrites;
+};
+
+static struct PlantParams Params SIM_WORLD = PLANT_PARAMS_DEFAULT;
+static struct PlantState Plant SIM_WORLD;
+
+static uint32_t plantLimits(void){
+	return (plantLimitClosed(&Plant, &Params) ? IN_LIMIT_CLOSED : 0) |
+	       (plantLimitOpened(&Plant, &Params) ? IN_LIMIT_OPENED : 0);
+}
+
+static void replayAdvance(struct Replay *r){
+	char line[128];
+	while (fgets(line, sizeof line, r->f)){
+		double t;
+		unsigned pin, value, word, motor;
+		if (line[0] == '#'){
+			continue;
+		}
+		if (sscanf(line, "%lf %u %u %x %u", &t, &pin, &value, &word, &motor) == 5){
+			r->nextUs = t;
+			r->nextPin = pin;
+			r->nextValue = value;
+			r->nextWord = word;
+			return;
+		}
+	}
+	r->done = true;
+}
+
+// Power-on or watchdog reset: SystemInit's boot stamp, then main. A
+// travel given on the command line stands in for a learned one.
+static void boot(const struct TravelTimes *travel){
+	bootProfileReset();
+	firmwareMain();
+	if (travel->upMs != 0 && travel->downMs != 0){
+		Config.travel = *travel;
+	}
+}
+
+// Where the glass really is, on the estimator's switch-to-switch scale
+static int actualPermille(void){
+	return (int)((Plant.position - Params.limitOpened) / (Params.limitClosed - Params.limitOpened) * 1000 + 0.5);
+}
+
+static void strokeStep(struct Strokes *s, uint32_t tick, struct Metrics *m){
+	if (s->left == 0 || tick < s->at){
+		return;
+	}
+	switch(s->state){
+		case STROKE_IDLE:
+			// A thermal block just waits for the model to cool
+			if (protectDutyLimit() == 0){
+				return;
+			}
+			simSetInputs(s->button);
+			s->state = STROKE_PRESSED;
+			s->at = tick + TAP_MS;
+			break;
+		case STROKE_PRESSED:
+			simSetInputs(0);
+			s->state = STROKE_RUNNING;
+			s->at = tick + SETTLE_MS;
+			break;
+		case STROKE_RUNNING:
+			if (motionActive() || motorRead() != MOTOR_OFF){
+				return;
+			}
+			m->strokes++;
+			s->left--;
+			s->button = s->button == IN_DRIVER_UP ? IN_DRIVER_DOWN : IN_DRIVER_UP;
+			s->state = STROKE_IDLE;
+			break;
+	}
+}
+
+static void usage(const char *argv0){
+	fprintf(stderr, "usage: %s [--eeprom file] [--replay file] [--start mm] [--obstacle mm] [--limit-fail]\n"
+	                "       [--cycles n] [--travel up,down] [--goto permille[@ms]]... [--jam ms] [--hang ms]\n"
+	                "       [--duration s] [--trace] [--profile file] [--bench-pool] [--bench-spsc]\n", argv0);
+	exit(2);
+}
+
+int main(int argc, char **argv){
+	// Before anything writes RAM: this is what a reset restores
+	simResetInit();
+
+	struct Replay replay = {0};
+	double startMm = 0;
+	double duration = 0;
+	uint32_t cycles = 1;
+	struct Goto gotos[MAX_GOTOS];
+	uint32_t gotoCount = 0;
+	struct TravelTimes travel = {0, 0};
+	double jamMs = -1;
+	bool trace = false;
+
+	for (int i = 1; i < argc; i++){
+		if (!strcmp(argv[i], "--eeprom") && i + 1 < argc){
+			simNvmOpen(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--replay") && i + 1 < argc){
+			replay.f = fopen(argv[++i], "r");
+			if (!replay.f){
+				perror(argv[i]);
+				return 1;
+			}
+		}
+		else if (!strcmp(argv[i], "--start") && i + 1 < argc){
+			startMm = atof(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--obstacle") && i + 1 < argc){
+			Params.obstacle = atof(argv[++i]) / 1000;
+		}
+		else if (!strcmp(argv[i], "--limit-fail")){
+			Params.limitClosed = Params.travel * 2;
+			Params.limitOpened = -1;
+		}
+		else if (!strcmp(argv[i], "--cycles") && i + 1 < argc){
+			cycles = (uint32_t)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--travel") && i + 1 < argc){
+			if (sscanf(argv[++i], "%u,%u", &travel.upMs, &travel.downMs) != 2){
+				usage(argv[0]);
+			}
+		}
+		else if (!strcmp(argv[i], "--goto") && i + 1 < argc && gotoCount < MAX_GOTOS){
+			struct Goto *g = &gotos[gotoCount++];
+			g->at = 0;
+			g->stopMs = -1;
+			g->error = 0;
+			if (sscanf(argv[++i], "%u@%u", &g->target, &g->at) < 1){
+				usage(argv[0]);
+			}
+		}
+		else if (!strcmp(argv[i], "--jam") && i + 1 < argc){
+			jamMs = atof(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--hang") && i + 1 < argc){
+			SimHangMs = (uint32_t)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--duration") && i + 1 < argc){
+			duration = atof(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--trace")){
+			trace = true;
+		}
+		else if (!strcmp(argv[i], "--bench-pool")){
+			simPoolBench();
+			return 0;
+		}
+		else if (!strcmp(argv[i], "--bench-spsc")){
+			simSpscBench();
+			return 0;
+		}
+		else if (!strcmp(argv[i], "--profile") && i + 1 < argc){
+			simProfileStart(argv[++i]);
+		}
+		else {
+			usage(argv[0]);
+		}
+	}
+
+	if (duration <= 0){
+		duration = (cycles != 0 ? cycles : 1) * CYCLE_S;
+	}
+	plantInit(&Plant, startMm / 1000);
+	simSetLimits(plantLimits());
+	boot(&travel);
+	if (replay.f){
+		replayAdvance(&replay);
+	}
+
+	// Without a replay or gotos the driver taps out one-touch strokes:
+	// close, open, ...
+	struct Strokes strokes = {STROKE_IDLE, IN_DRIVER_UP, replay.f || gotoCount ? 0 : cycles * 2, 1};
+	struct JamRun jam = {-1, -1, -1, 0, 0};
+	struct Recovery recovery = {SimHangMs != 0 ? (double)SimHangMs : -1.0, -1, -1, 0, 0};
+	uint32_t nextGoto = 0;
+	struct Goto *running = NULL;
+	struct Metrics m = {-1, -1, 0, 0, 0, 0, 0, 0};
+	uint32_t jams = 0;
+	long steps = (long)(duration / SIM_DT);
+
+	for (long step = 0; step < steps; step++){
+		double nowUs = step * SIM_DT * 1e6;
+
+		if (step % TICK_STEPS == 0){
+			uint32_t tick = (uint32_t)(step / TICK_STEPS);
+
+			while (replay.f && !replay.done && replay.nextUs <= nowUs){
+				simSetInputs(replay.nextWord);
+				if (replay.nextPin == LOG_PIN_JAM && replay.nextValue){
+					simSetJam(true);
+					simSetJam(false);
+				}
+				else if (replay.nextPin == LOG_PIN_AUTO && replay.nextValue){
+					simSetAuto(true);
+					simSetAuto(false);
+				}
+				replayAdvance(&replay);
+			}
+			strokeStep(&strokes, tick, &m);
+			if (jamMs >= 0 && tick == (uint32_t)jamMs){
+				simSetJam(true);
+				simSetJam(false);
+				if (jam.at < 0){
+					jam.at = tick;
+				}
+			}
+
+			if (nextGoto < gotoCount && tick >= gotos[nextGoto].at){
+				struct Goto *g = &gotos[nextGoto++];
+				if (running){
+					running->error = actualPermille() - (int)running->target;
+				}
+				g->at = tick;
+				if (!presetAtEnd(g->target) && !closureCalibrated()){
+					g->error = GOTO_REJECTED;
+				}
+				presetConfigure(PRESET_HALF, g->target);
+				postWindowMsg(MSG_PRESET, PRESET_HALF, 0);
+				running = g;
+			}
+
+			// Pins, then their interrupts, then whatever tasks they woke
+			simSetLimits(plantLimits());
+			if (gpioIntStatus(FAST_PORTB_BASE) != 0){
+				portBInterrupt();
+			}
+			if (gpioIntStatus(FAST_PORTF_BASE) != 0){
+				autoModeInterrupt();
+			}
+			simKernelRun();
+			simKernelTick();
+
+			if (simWatchdogStep()){
+				if (recovery.resets++ == 0){
+					recovery.resetMs = tick;
+					recovery.scans = simInputScans();
+				}
+				simReset();
+				boot(&travel);
+			}
+			if (recovery.resets != 0 && recovery.responsiveMs < 0 && simInputScans() != recovery.scans){
+				recovery.responsiveMs = tick;
+			}
+
+			if (running && running->stopMs < 0 && !motionActive()){
+				running->stopMs = tick - running->at;
+			}
+			if (ProtectStats.jams != jams){
+				jams = ProtectStats.jams;
+				if (jam.at < 0){
+					jam.at = tick;
+				}
+			}
+			// A jam ends the scripted strokes, the driver lets go
+			if (jam.at >= 0){
+				strokes.left = 0;
+			}
+			if (jam.at >= 0 && jam.startMs < 0 && motorRead() == MOTOR_DOWN){
+				jam.startMs = tick;
+				jam.startPos = Plant.position;
+			}
+			else if (jam.startMs >= 0 && jam.endMs < 0 && motorRead() != MOTOR_DOWN){
+				jam.endMs = tick;
+				jam.mm = (jam.startPos - Plant.position) * 1000;
+			}
+			if (motorRead() != MOTOR_OFF && m.startMs < 0){
+				m.startMs = tick;
+			}
+			if (protectDutyLimit() == 0){
+				m.blockedMs++;
+			}
+			m.travelWrites = ConfigStats.saves;
+
+			if (trace){
+				printf("%u %.1f %.3f %.2f %.1f %u %u\n", tick, Plant.position * 1000, Plant.velocity,
+				       Plant.current, Plant.obstacleForce, closurePosition(), motorRead());
+			}
+		}
+
+		double v = Params.supply * motorDuty() / 1000.0;
+		double voltage = motorRead() == MOTOR_UP ? v : motorRead() == MOTOR_DOWN ? -v : 0;
+		plantStep(&Plant, &Params, voltage, SIM_DT);
+		simSetCurrent(Plant.current);
+		simClockStep(SIM_DT);
+
+		double ms = nowUs / 1000;
+		if (fabs(Plant.current) > m.peakCurrent){
+			m.peakCurrent = fabs(Plant.current);
+		}
+		if (Plant.obstacleForce > 0){
+			m.pinchMs += SIM_DT * 1000;
+			if (Plant.obstacleForce > m.peakPinchN){
+				m.peakPinchN = Plant.obstacleForce;
+			}
+		}
+		if (m.closedMs < 0 && plantLimitClosed(&Plant, &Params)){
+			m.closedMs = ms;
+		}
+	}
+
+	simProfileStop();
+	if (running){
+		running->error = running->error == GOTO_REJECTED ? GOTO_REJECTED : actualPermille() - (int)running->target;
+	}
+	for (uint32_t i = 0; i < gotoCount; i++){
+		if (gotos[i].error == GOTO_REJECTED){
+			printf("goto_%u_target=%u rejected, position not calibrated\n", i, gotos[i].target);
+			continue;
+		}
+		if (gotos[i].stopMs < 0){
+			printf("goto_%u_target=%u preempted\n", i, gotos[i].target);
+			continue;
+		}
+		printf("goto_%u_target=%u time_ms=%.0f error_permille=%d\n", i, gotos[i].target, gotos[i].stopMs, gotos[i].error);
+	}
+	printf("travel_close_ms=%.0f\n", m.closedMs >= 0 && m.startMs >= 0 ? m.closedMs - m.startMs : -1);
+	printf("peak_pinch_n=%.1f\n", m.peakPinchN);
+	printf("pinch_ms=%.1f\n", m.pinchMs);
+	printf("peak_current_a=%.2f\n", m.peakCurrent);
+	printf("strokes=%u\n", m.strokes);
+	printf("jams=%u\n", ProtectStats.jams);
+	printf("jam_reverse_ms=%.0f\n", jam.endMs >= 0 ? jam.endMs - jam.startMs : -1);
+	printf("jam_reverse_mm=%.1f\n", jam.mm);
+	printf("stalls=%u\n", ProtectStats.stalls);
+	printf("thermal_trips=%u\n", ProtectStats.trips);
+	printf("peak_heat_pct=%u\n", ProtectStats.peakHeatPct);
+	printf("blocked_ms=%.0f\n", m.blockedMs);
+	printf("learned_up_ms=%u\n", Config.travel.upMs);
+	printf("learned_down_ms=%u\n", Config.travel.downMs);
+	printf("config_source=%s seq=%u slot=%u\n", ConfigStats.source == CONFIG_EEPROM ? "eeprom" : "defaults", ConfigStats.seq, ConfigStats.slot);
+	printf("travel_writes=%u\n", m.travelWrites);
+	printf("estimate_error_last=%u\n", ClosureStats.lastError);
+	printf("estimate_error_max=%u\n", ClosureStats.maxError);
+	printf("final_position_mm=%.1f\n", Plant.position * 1000);
+	printf("estimate_permille=%u\n", closurePosition());
+	printf("watchdog_resets=%u\n", recovery.resets);
+	printf("hang_to_reset_ms=%.0f\n", recovery.resetMs >= 0 ? recovery.resetMs - recovery.hangMs : -1);
+	printf("hang_to_responsive_ms=%.0f\n", recovery.responsiveMs >= 0 ? recovery.responsiveMs - recovery.hangMs : -1);
+	printf("watchdog_recoveries=%u\n", Retained.recoveries);
+	printf("watchdog_missing=%#x\n", Retained.lastMissing);
+	simClockReport();
+	return 0;
+}
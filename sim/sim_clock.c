@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "clock.h"
+#include "sim_hw.h"
+
+// Host stand-in for clock.c: the same two operating points and clients,
+// with the transition time and the MCU supply current taken from a model
+// rather than RCC2. The currents are assumed run-mode figures with the used
+// peripherals clocked; replace them with bench measurements when taken.
+#define FULL_MA 45.0
+#define LOW_MA 6.0
+#define PLL_LOCK_US 500.0   // assumed lock time, ClockStats.lockUsMax on target
+#define REDERIVE_US 4.0     // clients plus SysTick, a few dozen stores
+
+// SystemInit leaves the core on the PIOSC
+uint32_t SystemCoreClock = CLOCK_PIOSC_HZ;
+volatile struct ClockStats ClockStats;
+
+static ClockFn Clients[CLOCK_CLIENTS];
+static enum ClockPoint Point;
+static double Cycles;
+
+// The supply is metered across resets
+static double Seconds[CLOCK_POINTS] SIM_WORLD;
+static double Charge SIM_WORLD;         // mA * s
+static double Pending SIM_WORLD;        // s of PLL lock still to charge at FULL_MA
+
+void clockInit(void){
+	SystemCoreClock = CLOCK_LOW_HZ;
+	Point = CLOCK_LOW;
+	clockSelect(CLOCK_FULL);
+}
+
+void clockSetup(enum ClockClient id, ClockFn fn){
+	Clients[id] = fn;
+}
+
+void clockSelect(enum ClockPoint point){
+	if (point == Point){
+		return;
+	}
+	if (point == CLOCK_FULL){
+		Pending += PLL_LOCK_US * 1e-6;
+		ClockStats.lockUsLast = (uint32_t)PLL_LOCK_US;
+		ClockStats.lockUsMax = ClockStats.lockUsLast;
+	}
+	SystemCoreClock = point == CLOCK_FULL ? CLOCK_FULL_HZ : CLOCK_LOW_HZ;
+	for(uint32_t i = 0; i < CLOCK_CLIENTS; i++){
+		if (Clients[i] != NULL){
+			Clients[i]();
+		}
+	}
+	ClockStats.switchUsLast = (uint32_t)REDERIVE_US;
+	ClockStats.switchUsMax = ClockStats.switchUsLast;
+	ClockStats.switches++;
+	ClockStats.point = point;
+	Point = point;
+}
+
+uint32_t simCycles(void){
+	return (uint32_t)Cycles;
+}
+
+void simCyclesReset(void){
+	Cycles = 0;
+}
+
+// The PLL draws from power-up, so the lock counts at the full current
+void simClockStep(double dt){
+	double ma = Point == CLOCK_FULL || Pending > 0 ? FULL_MA : LOW_MA;
+	if (Pending > 0){
+		Pending -= dt;
+	}
+	Seconds[Point] += dt;
+	Charge += ma * dt;
+	Cycles += dt * SystemCoreClock;
+	if (Cycles >= 4294967296.0){
+		Cycles -= 4294967296.0;
+	}
+}
+
+void simClockReport(void){
+	double total = Seconds[CLOCK_LOW] + Seconds[CLOCK_FULL];
+	double avg = total > 0 ? Charge / total : 0;
+	printf("clock_switches=%u\n", ClockStats.switches);
+	printf("clock_up_us=%.0f\n", PLL_LOCK_US + REDERIVE_US);
+	printf("clock_down_us=%.0f\n", REDERIVE_US);
+	printf("clock_low_pct=%.1f\n", total > 0 ? 100.0 * Seconds[CLOCK_LOW] / total : 0);
+	printf("mcu_idle_ma=%.1f full_ma=%.1f\n", LOW_MA, FULL_MA);
+	printf("mcu_avg_ma=%.2f\n", avg);
+	printf("mcu_saving_pct=%.1f\n", avg < FULL_MA ? 100.0 * (FULL_MA - avg) / FULL_MA : 0.0);
+}
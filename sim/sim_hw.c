@@ -0,0 +1,165 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio_fast.h"
+#include "inputs.h"
+#include "motion.h"
+#include "current.h"
+#include "sim_hw.h"
+
+// Input word is the packed, active-high form from inputs.h; the accessors
+// invert it back into pin levels. What the switches are doing survives a
+// reset, the peripheral registers (PWM, edge latches, WDT0) do not.
+static uint32_t Inputs SIM_WORLD;
+static uint32_t Limits SIM_WORLD;
+static bool Jam SIM_WORLD;
+static bool Auto SIM_WORLD;
+static double Current SIM_WORLD;
+static uint32_t Scans SIM_WORLD;
+static bool ResetByWdt SIM_WORLD;
+
+static uint32_t Motor;
+static uint32_t Duty;
+static uint32_t EdgesB;
+static uint32_t EdgesF;
+
+// WDT0 as watchdog.h describes it: the first timeout raises the
+// interrupt, the second resets; a kick or a LOAD write restarts the count
+static uint32_t WdtLoadMs;
+static uint32_t WdtLeftMs;
+static bool WdtRunning;
+static bool WdtFlag;
+
+uint32_t SimHangMs;
+
+uint32_t gpioReadB(void){
+	return ~(Inputs | Limits) & PB_INPUTS;
+}
+
+// inputsSample reads C once per scan, which is how the simulator sees the
+// input task is alive
+uint32_t gpioReadC(void){
+	Scans++;
+	return ~(Inputs >> 8) & PC_INPUTS;
+}
+
+uint32_t gpioReadD(void){
+	return ~(Inputs >> 16) & PD_INPUTS;
+}
+
+void motorWrite(uint32_t dir){
+	Motor = dir & PD_MOTOR;
+}
+
+uint32_t motorRead(void){
+	return Motor;
+}
+
+uint32_t gpioIntStatus(uint32_t base){
+	return base == FAST_PORTB_BASE ? EdgesB : base == FAST_PORTF_BASE ? EdgesF : 0;
+}
+
+void gpioIntClear(uint32_t base, uint32_t mask){
+	if (base == FAST_PORTB_BASE){
+		EdgesB &= ~mask;
+	}
+	else if (base == FAST_PORTF_BASE){
+		EdgesF &= ~mask;
+	}
+}
+
+void motorPwmInit(void){
+	motorSetDuty(1000);
+}
+
+void motorSetDuty(uint32_t duty){
+	Duty = duty;
+}
+
+uint32_t motorDuty(void){
+	return Duty;
+}
+
+void currentInit(void){
+}
+
+uint32_t currentReadMa(uint32_t duty){
+	return duty != 0 ? simAdcCurrentMa() : 0;
+}
+
+void wdtStart(uint32_t ms){
+	WdtLoadMs = ms;
+	WdtLeftMs = ms;
+	WdtFlag = false;
+	WdtRunning = true;
+}
+
+void wdtLoad(uint32_t ms){
+	WdtLoadMs = ms;
+	WdtLeftMs = ms;
+}
+
+void wdtKick(void){
+	WdtFlag = false;
+	WdtLeftMs = WdtLoadMs;
+}
+
+bool wdtCausedReset(void){
+	bool was = ResetByWdt;
+	ResetByWdt = false;
+	return was;
+}
+
+// Once per ms, true when WDT0 resets the MCU
+bool simWatchdogStep(void){
+	if (!WdtRunning || --WdtLeftMs != 0){
+		return false;
+	}
+	WdtLeftMs = WdtLoadMs;
+	if (!WdtFlag){
+		WdtFlag = true;
+		return false;
+	}
+	ResetByWdt = true;
+	return true;
+}
+
+uint32_t simInputScans(void){
+	return Scans;
+}
+
+void simSetInputs(uint32_t word){
+	Inputs = word & ~(IN_LIMIT_CLOSED | IN_LIMIT_OPENED);
+}
+
+// Both edges of a limit switch interrupt (ROLE_IRQ_BOTH)
+void simSetLimits(uint32_t word){
+	word &= IN_LIMIT_CLOSED | IN_LIMIT_OPENED;
+	EdgesB |= Limits ^ word;
+	Limits = word;
+}
+
+// Jam and auto inputs interrupt on the press (ROLE_IRQ_FALL)
+void simSetJam(bool pressed){
+	if (pressed && !Jam){
+		EdgesB |= PB_JAM;
+	}
+	Jam = pressed;
+}
+
+void simSetAuto(bool pressed){
+	if (pressed && !Auto){
+		EdgesF |= PF_AUTO;
+	}
+	Auto = pressed;
+}
+
+void simSetCurrent(double amps){
+	Current = amps;
+}
+
+// Low-side shunt as the ADC path would convert it: only current flowing in
+// the driven direction registers, regeneration while slowing down reads 0.
+uint32_t simAdcCurrentMa(void){
+	double ma = (Motor == MOTOR_DOWN ? -Current : Current) * 1000;
+	return ma > 0 ? (uint32_t)ma : 0;
+}
@@ -0,0 +1,61 @@
+#ifndef SIM_HW_H
+#define SIM_HW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Everything outside the MCU (plant, pin levels, EEPROM image, power
+// accounting) lives in this section, which a simulated reset leaves
+// alone; the rest of RAM goes back to its load image (sim/reset.c).
+#define SIM_WORLD __attribute__((section("sim_world")))
+
+// Host stand-ins for the register accessors in gpio_fast.h. Pin levels are
+// raw (active low) exactly as the firmware would read them.
+uint32_t gpioReadB(void);
+uint32_t gpioReadC(void);
+uint32_t gpioReadD(void);
+void motorWrite(uint32_t dir);
+uint32_t motorRead(void);
+uint32_t gpioIntStatus(uint32_t base);
+void gpioIntClear(uint32_t base, uint32_t mask);
+
+// WDT0 and the reset cause, for watchdog.c
+void wdtStart(uint32_t ms);
+void wdtLoad(uint32_t ms);
+void wdtKick(void);
+bool wdtCausedReset(void);
+
+// DWT cycle counter, for cycles.h
+uint32_t simCycles(void);
+void simCyclesReset(void);
+
+// Fault injection for CheckButtons: the input task stops checking in once
+// the tick passes SimHangMs (0 never). Lives in ordinary RAM, so the
+// watchdog reset that follows clears it.
+extern uint32_t SimHangMs;
+#define WATCHDOG_INJECT_HANG (SimHangMs != 0 ? SimHangMs : UINT32_MAX)
+
+// Kernel shim (kernel.c) and reset model (reset.c)
+void simKernelTick(void);
+void simKernelRun(void);
+void simResetInit(void);
+void simReset(void);
+
+// Simulator side
+void simSetInputs(uint32_t word);
+void simSetLimits(uint32_t word);
+void simSetJam(bool pressed);
+void simSetAuto(bool pressed);
+uint32_t simInputScans(void);
+bool simWatchdogStep(void);
+void simSetCurrent(double amps);
+uint32_t simAdcCurrentMa(void);
+void simNvmOpen(const char *path);
+void simProfileStart(const char *path);
+void simProfileStop(void);
+void simPoolBench(void);
+void simSpscBench(void);
+void simClockStep(double dt);
+void simClockReport(void);
+
+#endif
@@ -0,0 +1,100 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "pool.h"
+#include "sim_hw.h"
+
+// Pool benchmark: a four-block burst, as a burst of messages would take,
+// timed against libc malloc, then two threads hammering one pool to check
+// that no block is ever handed out twice.
+
+#define HOST_BURST 4
+#define HOST_BLOCK 32
+#define HOST_ROUNDS 1000000
+#define STRESS_ROUNDS 2000000
+
+struct HostBlock {
+	volatile uint32_t owner;
+	uint32_t words[HOST_BLOCK / sizeof(uint32_t) - 1];
+};
+
+POOL_DEFINE(hostPool, struct HostBlock, 8);
+
+static volatile uint32_t Collisions;
+
+static double nowNs(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double timePool(void){
+	void *blocks[HOST_BURST];
+	double start = nowNs();
+	for (uint32_t r = 0; r < HOST_ROUNDS; r++){
+		for (int i = 0; i < HOST_BURST; i++){
+			blocks[i] = poolAlloc(&hostPool);
+		}
+		__asm__ volatile("" ::: "memory");
+		for (int i = 0; i < HOST_BURST; i++){
+			poolFree(&hostPool, blocks[i]);
+		}
+	}
+	return (nowNs() - start) / HOST_ROUNDS;
+}
+
+static double timeMalloc(void){
+	void *blocks[HOST_BURST];
+	double start = nowNs();
+	for (uint32_t r = 0; r < HOST_ROUNDS; r++){
+		for (int i = 0; i < HOST_BURST; i++){
+			blocks[i] = malloc(HOST_BLOCK);
+		}
+		__asm__ volatile("" ::: "memory");
+		for (int i = 0; i < HOST_BURST; i++){
+			free(blocks[i]);
+		}
+	}
+	return (nowNs() - start) / HOST_ROUNDS;
+}
+
+static void *stress(void *arg){
+	uint32_t id = (uint32_t)(uintptr_t)arg;
+	for (uint32_t r = 0; r < STRESS_ROUNDS; r++){
+		struct HostBlock *b = poolAlloc(&hostPool);
+		if (!b){
+			continue;
+		}
+		if (b->owner != 0){
+			__atomic_add_fetch(&Collisions, 1, __ATOMIC_RELAXED);
+		}
+		b->owner = id;
+		if (b->owner != id){
+			__atomic_add_fetch(&Collisions, 1, __ATOMIC_RELAXED);
+		}
+		b->owner = 0;
+		poolFree(&hostPool, b);
+	}
+	return NULL;
+}
+
+void simPoolBench(void){
+	poolInit(&hostPool);
+	printf("pool_alloc_free_ns=%.1f\n", timePool());
+	printf("malloc_alloc_free_ns=%.1f\n", timeMalloc());
+	printf("pool_high_water=%u\n", hostPool.highWater);
+	
+	pthread_t threads[2];
+	for (uintptr_t i = 0; i < 2; i++){
+		pthread_create(&threads[i], NULL, stress, (void *)(i + 1));
+	}
+	for (int i = 0; i < 2; i++){
+		pthread_join(threads[i], NULL);
+	}
+	printf("pool_stress_collisions=%u\n", Collisions);
+	printf("pool_stress_empty=%u\n", hostPool.failures);
+	printf("pool_stress_used=%u\n", hostPool.used);
+}
@@ -0,0 +1,71 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+#include <string.h>
+#include <ucontext.h>
+#include <sys/time.h>
+#include "sim_hw.h"
+
+// Host stand-in for profile.c: SIGPROF at the firmware's sample rate of
+// CPU time, the interrupted PC goes into a fixed buffer (nothing else is
+// async-signal-safe to do), written out as text for tools/profile.py.
+// There is no stacked LR to take on the host, so the profile is flat.
+
+#define HOST_PROFILE_HZ 1009
+#define HOST_SAMPLES 65536
+
+// Host state, kept across a simulated reset
+static uintptr_t Samples[HOST_SAMPLES] SIM_WORLD;
+static volatile sig_atomic_t Count SIM_WORLD;
+static FILE *Out SIM_WORLD;
+
+int main(int argc, char **argv);
+
+static void onSample(int sig, siginfo_t *info, void *context){
+	(void)sig;
+	(void)info;
+	ucontext_t *uc = context;
+	if (Count >= HOST_SAMPLES){
+		return;
+	}
+#if defined(__x86_64__)
+	Samples[Count++] = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+	Samples[Count++] = (uintptr_t)uc->uc_mcontext.pc;
+#else
+	(void)uc;
+#endif
+}
+
+void simProfileStart(const char *path){
+	Out = fopen(path, "w");
+	if (!Out){
+		perror(path);
+		return;
+	}
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = onSample;
+	sa.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigaction(SIGPROF, &sa, NULL);
+	
+	struct itimerval period = {{0, 1000000 / HOST_PROFILE_HZ}, {0, 1000000 / HOST_PROFILE_HZ}};
+	setitimer(ITIMER_PROF, &period, NULL);
+}
+
+// The "main" line lets the tool relocate a position-independent binary
+void simProfileStop(void){
+	if (!Out){
+		return;
+	}
+	struct itimerval off = {{0, 0}, {0, 0}};
+	setitimer(ITIMER_PROF, &off, NULL);
+	
+	fprintf(Out, "# rate %d\n# main %#lx\n", HOST_PROFILE_HZ, (unsigned long)(uintptr_t)main);
+	for (sig_atomic_t i = 0; i < Count; i++){
+		fprintf(Out, "%#lx 0\n", (unsigned long)Samples[i]);
+	}
+	fclose(Out);
+	Out = NULL;
+}
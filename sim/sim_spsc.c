@@ -0,0 +1,142 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "spsc.h"
+#include "sim_hw.h"
+
+// Host side of the ring benchmark in bench.c: one producer thread pushing
+// sequence numbers and one consumer popping in batches, checking that
+// nothing is lost, repeated or torn. The same traffic then goes through a
+// mutex-guarded ring, which is what xQueueSend/xQueueReceive amount to
+// (copy under a lock); there is no POSIX FreeRTOS port in this tree.
+
+#define STRESS_ITEMS 5000000
+#define RING_SIZE 64
+#define BATCH 16
+
+struct Item {
+	uint32_t seq;
+	uint32_t check;
+};
+
+SPSC_DEFINE(hostRing, struct Item, RING_SIZE);
+
+struct Locked {
+	pthread_mutex_t lock;
+	uint32_t head;
+	uint32_t tail;
+	struct Item items[RING_SIZE];
+};
+
+static struct Locked hostLocked = {PTHREAD_MUTEX_INITIALIZER, 0, 0, {{0, 0}}};
+static uint32_t Errors;
+
+static double nowNs(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int lockedPush(struct Locked *q, const struct Item *item){
+	int ok = 0;
+	pthread_mutex_lock(&q->lock);
+	if (q->head - q->tail < RING_SIZE){
+		q->items[q->head++ % RING_SIZE] = *item;
+		ok = 1;
+	}
+	pthread_mutex_unlock(&q->lock);
+	return ok;
+}
+
+static int lockedPop(struct Locked *q, struct Item *item){
+	int ok = 0;
+	pthread_mutex_lock(&q->lock);
+	if (q->head != q->tail){
+		*item = q->items[q->tail++ % RING_SIZE];
+		ok = 1;
+	}
+	pthread_mutex_unlock(&q->lock);
+	return ok;
+}
+
+// Full or empty yields rather than spins so the run also works on one core
+static void *spscProducer(void *arg){
+	(void)arg;
+	for (uint32_t seq = 0; seq < STRESS_ITEMS; seq++){
+		struct Item item = {seq, ~seq};
+		while (!spscPush(&hostRing, &item)){
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void *lockedProducer(void *arg){
+	(void)arg;
+	for (uint32_t seq = 0; seq < STRESS_ITEMS; seq++){
+		struct Item item = {seq, ~seq};
+		while (!lockedPush(&hostLocked, &item)){
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void expect(uint32_t *next, const struct Item *item){
+	if (item->seq != *next || item->check != ~item->seq){
+		Errors++;
+	}
+	*next = item->seq + 1;
+}
+
+static double runSpsc(void){
+	pthread_t producer;
+	struct Item batch[BATCH];
+	uint32_t next = 0;
+	double start = nowNs();
+	pthread_create(&producer, NULL, spscProducer, NULL);
+	while (next < STRESS_ITEMS){
+		uint32_t n = spscPopBatch(&hostRing, batch, BATCH);
+		if (n == 0){
+			sched_yield();
+		}
+		for (uint32_t i = 0; i < n; i++){
+			expect(&next, &batch[i]);
+		}
+	}
+	pthread_join(producer, NULL);
+	return STRESS_ITEMS / ((nowNs() - start) * 1e-3);
+}
+
+static double runLocked(void){
+	pthread_t producer;
+	struct Item item;
+	uint32_t next = 0;
+	double start = nowNs();
+	pthread_create(&producer, NULL, lockedProducer, NULL);
+	while (next < STRESS_ITEMS){
+		if (!lockedPop(&hostLocked, &item)){
+			sched_yield();
+			continue;
+		}
+		expect(&next, &item);
+	}
+	pthread_join(producer, NULL);
+	return STRESS_ITEMS / ((nowNs() - start) * 1e-3);
+}
+
+void simSpscBench(void){
+	double spsc = runSpsc();
+	uint32_t spscErrors = Errors;
+	Errors = 0;
+	double locked = runLocked();
+	printf("spsc_items=%u\n", STRESS_ITEMS);
+	printf("spsc_stress_errors=%u\n", spscErrors);
+	printf("spsc_left=%u\n", spscCount(&hostRing));
+	printf("spsc_mitems_per_s=%.2f\n", spsc);
+	printf("locked_queue_errors=%u\n", Errors);
+	printf("locked_queue_mitems_per_s=%.2f\n", locked);
+}
@@ -0,0 +1,45 @@
+#ifndef SIM_TASK_H
+#define SIM_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct SimTask *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+	eNoAction,
+	eSetBits
+} eNotifyAction;
+
+#define taskSCHEDULER_SUSPENDED   0
+#define taskSCHEDULER_NOT_STARTED 1
+#define taskSCHEDULER_RUNNING     2
+
+void simCriticalEnter(void);
+void simCriticalExit(void);
+void simTaskYield(void);
+#define taskENTER_CRITICAL() simCriticalEnter()
+#define taskEXIT_CRITICAL() simCriticalExit()
+#define taskYIELD() simTaskYield()
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t code, const char *name, uint32_t depth, void *param,
+                               UBaseType_t priority, StackType_t *stack, StaticTask_t *tcb);
+void vTaskStartScheduler(void);
+BaseType_t xTaskGetSchedulerState(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previous, TickType_t increment);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+char *pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t task);
+void vTaskSetTaskNumber(TaskHandle_t task, UBaseType_t number);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *woken);
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t *value, TickType_t ticks);
+uint32_t ulTaskNotifyValueClear(TaskHandle_t task, uint32_t clear);
+
+#endif
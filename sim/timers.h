@@ -0,0 +1,19 @@
+#ifndef SIM_TIMERS_H
+#define SIM_TIMERS_H
+
+#include "FreeRTOS.h"
+
+typedef struct SimTimer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+typedef void (*PendedFunction_t)(void *param1, uint32_t param2);
+
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t autoReload, void *id,
+                                 TimerCallbackFunction_t callback, StaticTimer_t *buffer);
+void *pvTimerGetTimerID(TimerHandle_t timer);
+void vTimerSetReloadMode(TimerHandle_t timer, UBaseType_t autoReload);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks);
+BaseType_t xTimerChangePeriodFromISR(TimerHandle_t timer, TickType_t period, BaseType_t *woken);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks);
+BaseType_t xTimerPendFunctionCall(PendedFunction_t function, void *param1, uint32_t param2, TickType_t ticks);
+
+#endif
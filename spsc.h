@@ -0,0 +1,65 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Lock-free single-producer/single-consumer ring. head is only written by
+// the producer, tail only by the consumer, so an ISR can push while a task
+// pops without masking interrupts. Capacity must be a power of two.
+struct Spsc {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint32_t mask;
+	uint32_t elemSize;
+	uint8_t *buf;
+};
+
+#define SPSC_DEFINE(name, type, size) \
+	_Static_assert(((size) & ((size) - 1)) == 0, #name " size must be a power of two"); \
+	static type name##Storage[size]; \
+	static struct Spsc name = {0, 0, (size) - 1, sizeof(type), (uint8_t *)name##Storage}
+
+#define spscBarrier() __sync_synchronize()
+
+static inline uint32_t spscCount(const struct Spsc *q){
+	return q->head - q->tail;
+}
+
+static inline uint32_t spscFree(const struct Spsc *q){
+	return q->mask + 1 - spscCount(q);
+}
+
+// Producer side, safe from an ISR. Returns 0 when full.
+static inline int spscPush(struct Spsc *q, const void *elem){
+	uint32_t head = q->head;
+	if (head - q->tail > q->mask){
+		return 0;
+	}
+	memcpy(&q->buf[(head & q->mask) * q->elemSize], elem, q->elemSize);
+	spscBarrier();
+	q->head = head + 1;
+	return 1;
+}
+
+// Consumer side, pops up to max elements in one pass
+static inline uint32_t spscPopBatch(struct Spsc *q, void *out, uint32_t max){
+	uint32_t tail = q->tail;
+	uint32_t n = q->head - tail;
+	if (n > max){
+		n = max;
+	}
+	spscBarrier();
+	for(uint32_t i = 0; i < n; i++){
+		memcpy((uint8_t *)out + i * q->elemSize, &q->buf[((tail + i) & q->mask) * q->elemSize], q->elemSize);
+	}
+	spscBarrier();
+	q->tail = tail + n;
+	return n;
+}
+
+static inline int spscPop(struct Spsc *q, void *out){
+	return (int)spscPopBatch(q, out, 1);
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "timers.h"
+#include "cycles.h"
+#include "timeouts.h"
+
+_Static_assert(configUSE_TIMERS == 1, "timeouts need the timer service task");
+_Static_assert(TIMEOUT_COMMANDS <= configTIMER_QUEUE_LENGTH, "timer command queue below the static budget");
+
+volatile struct TimeoutStats TimeoutStats;
+
+static StaticTimer_t TimerBuffers[TIMEOUTS];
+static TimerHandle_t Timers[TIMEOUTS];
+static TimeoutFn Handlers[TIMEOUTS];
+
+static void expired(TimerHandle_t timer){
+	uint32_t id = (uint32_t)(uintptr_t)pvTimerGetTimerID(timer);
+	TimeoutStats.fired++;
+	if (Handlers[id] != NULL && !Handlers[id](id)){
+		TimeoutStats.dropped++;
+	}
+}
+
+// Periods are placeholders until the first start; one-shots stay dormant
+void timeoutsInit(void){
+	for(uint32_t i = 0; i < TIMEOUTS; i++){
+		Timers[i] = xTimerCreateStatic("timeout", 1, pdFALSE, (void *)(uintptr_t)i, expired, &TimerBuffers[i]);
+	}
+}
+
+void timeoutSetup(enum Timeout id, TimeoutFn fn, bool periodic){
+	Handlers[id] = fn;
+	vTimerSetReloadMode(Timers[id], periodic ? pdTRUE : pdFALSE);
+}
+
+// (Re)arms the timer ms from now; never blocks the caller
+void timeoutStart(enum Timeout id, uint32_t ms){
+	TickType_t ticks = pdMS_TO_TICKS(ms);
+	if (xTimerChangePeriod(Timers[id], ticks != 0 ? ticks : 1, 0) == pdPASS){
+		TimeoutStats.started++;
+	}
+	else {
+		TimeoutStats.dropped++;
+	}
+}
+
+void timeoutStartFromISR(enum Timeout id, TickType_t ticks, BaseType_t *woken){
+	if (xTimerChangePeriodFromISR(Timers[id], ticks != 0 ? ticks : 1, woken) == pdPASS){
+		TimeoutStats.started++;
+	}
+	else {
+		TimeoutStats.dropped++;
+	}
+}
+
+void timeoutStop(enum Timeout id){
+	if (xTimerStop(Timers[id], 0) != pdPASS){
+		TimeoutStats.dropped++;
+	}
+}
+
+static void probed(void *stamp, uint32_t unused){
+	(void)unused;
+	uint32_t latency = cyclesToUs(cyclesNow() - (uint32_t)(uintptr_t)stamp);
+	TimeoutStats.latencyUsLast = latency;
+	if (latency > TimeoutStats.latencyUsMax){
+		TimeoutStats.latencyUsMax = latency;
+	}
+}
+
+// Queues a no-op behind whatever commands are pending and measures how
+// long the service task takes to reach it under the current load
+void timeoutProbe(void){
+	if (xTimerPendFunctionCall(probed, (void *)(uintptr_t)cyclesNow(), 0, 0) != pdPASS){
+		TimeoutStats.dropped++;
+	}
+}
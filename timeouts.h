@@ -0,0 +1,48 @@
+#ifndef TIMEOUTS_H
+#define TIMEOUTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+
+// Every software timer in the firmware, created statically at boot. The
+// callbacks run in the timer service task and only post an event or a
+// deferred work bit to the task that owns the work; they never block and
+// never drive hardware.
+enum Timeout {
+	TIMEOUT_JAM_REVERSE,    // one-shot, controller stops the jam reversal
+	TIMEOUT_MOTION,         // one-shot, auto travel backstop (MOTION_TIMEOUT)
+	TIMEOUT_LIMIT_DEBOUNCE, // one-shot, armed from the port B ISR
+	TIMEOUT_TELEMETRY,      // periodic
+	TIMEOUTS
+};
+
+#define TELEMETRY_PERIOD_MS 1000
+
+// Each timer has at most a change-period and a stop in flight, plus one
+// latency probe; the service queue is sized for that so a command from
+// an ISR is never dropped.
+#define TIMEOUT_COMMANDS (2 * TIMEOUTS + 1)
+
+// Runs in the timer service task. Returns false if the event could not
+// be posted, which is counted in TimeoutStats.dropped.
+typedef bool (*TimeoutFn)(uint32_t id);
+
+struct TimeoutStats {
+	uint32_t started;
+	uint32_t fired;
+	uint32_t dropped;
+	uint32_t latencyUsLast;   // command queued to the service task running it
+	uint32_t latencyUsMax;
+};
+
+extern volatile struct TimeoutStats TimeoutStats;
+
+void timeoutsInit(void);
+void timeoutSetup(enum Timeout id, TimeoutFn fn, bool periodic);
+void timeoutStart(enum Timeout id, uint32_t ms);
+void timeoutStartFromISR(enum Timeout id, TickType_t ticks, BaseType_t *woken);
+void timeoutStop(enum Timeout id);
+void timeoutProbe(void);
+
+#endif
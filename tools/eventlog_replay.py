@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Decode an EventLog dump into a timed replay stream.
+
+The dump is either the RAM ring (Keil: SAVE dump.bin &EventLog, &EventLog + sizeof(EventLog))
+or the EEPROM copy written by eventLogPersist(). Both start with the same
+four word header: magic, head, dropped, lastStamp.
+
+Deltas count cycles at whatever clock was running; LOG_PIN_CLOCK records
+mark each switch between CLOCK_FULL and CLOCK_LOW (clock.h), so each
+stretch converts at its own rate. A LOG_PIN_GAP record carries the high
+bits of a long gap, including the whole CYCCNT wraps the firmware counted
+from the RTOS tick, so idle gaps replay exactly up to 2^32 ticks (49.7
+days); a longer gap comes out short by whole tick-counter wraps.
+
+Output is one line per record:  <time_us> <pin> <value> <input_word> <motor>
+which the simulator replays with --replay.
+"""
+import argparse
+import struct
+import sys
+
+LOG_MAGIC = 0x474F4C57
+LOG_TIME_SHIFT = 4
+LOG_DELTA_BITS = 24
+LOG_PIN_CLOCK = 126
+LOG_PIN_GAP = 127
+LOG_PIN_MOTOR_UP = 16
+LOG_PIN_MOTOR_DOWN = 17
+INPUT_PINS = (0, 1, 4, 8 + 5, 8 + 6, 16 + 2, 16 + 3)
+CLOCK_FULL_HZ = 80e6
+CLOCK_LOW_HZ = 4e6
+
+
+def read_records(data):
+    magic, head, dropped, _ = struct.unpack_from('<4I', data, 0)
+    if magic != LOG_MAGIC:
+        sys.exit('bad magic %#x' % magic)
+    size = (len(data) - 16) // 4
+    records = struct.unpack_from('<%dI' % size, data, 16)
+    count = min(head, size)
+    start = head - count
+    return [records[(start + i) % size] for i in range(count)], dropped
+
+
+def first_clock(records, clock_hz):
+    """Clock at the oldest record: the other point before the first switch, else clock_hz."""
+    for rec in records:
+        if (rec >> 1) & 0x7F == LOG_PIN_CLOCK:
+            return CLOCK_LOW_HZ if rec & 1 else CLOCK_FULL_HZ
+    return clock_hz
+
+
+def replay(records, clock_hz):
+    us = 0.0
+    word = 0
+    motor = 0
+    hz = first_clock(records, clock_hz)
+    for rec in records:
+        delta = rec >> 8
+        pin = (rec >> 1) & 0x7F
+        value = rec & 1
+        if pin == LOG_PIN_GAP:
+            us += ((delta << LOG_DELTA_BITS) << LOG_TIME_SHIFT) * 1e6 / hz
+            continue
+        us += (delta << LOG_TIME_SHIFT) * 1e6 / hz
+        if pin == LOG_PIN_CLOCK:
+            hz = CLOCK_FULL_HZ if value else CLOCK_LOW_HZ
+            continue
+        if pin in INPUT_PINS:
+            word = (word | (1 << pin)) if value else (word & ~(1 << pin))
+        elif pin in (LOG_PIN_MOTOR_UP, LOG_PIN_MOTOR_DOWN):
+            bit = 1 << (pin - LOG_PIN_MOTOR_UP)
+            motor = (motor | bit) if value else (motor & ~bit)
+        yield us, pin, value, word, motor
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('dump')
+    ap.add_argument('--clock', type=float, default=CLOCK_FULL_HZ,
+                    help='SystemCoreClock when recorded, for dumps without a clock switch')
+    args = ap.parse_args()
+
+    with open(args.dump, 'rb') as f:
+        records, dropped = read_records(f.read())
+    if dropped:
+        print('# %d records dropped before this window' % dropped)
+    for t, pin, value, word, motor in replay(records, args.clock):
+        print('%.1f %d %d 0x%06x %d' % (t, pin, value, word, motor))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,295 @@
+#!/usr/bin/env python3
+"""Break a linker map down into flash/RAM per object and per symbol.
+
+Reads the armlink map (Listings/Finalproject.map) or a GNU ld map
+(-Wl,-Map=...) and prints per-object totals, the largest symbols and
+anything worth a second look, then checks the result against
+tools/footprint_budget.json. Exits non-zero when a budget is exceeded;
+--update rewrites the budget from the map instead.
+
+Limits are the measured size plus headroom_pct, rounded up to 16 bytes,
+so a budget written by --update passes on the map it came from. The
+budget is only enforced once "enforce" is set, which --update does; a
+budget that has not been re-baselined from a map of the current tree
+is reported but does not fail the check.
+
+Both builds use one section per function and variable, so an input
+section is a symbol. Flash counts code, read-only data and the initial
+image of initialised RAM (before armlink's RW compression); RAM counts
+initialised and zeroed data. Library members are folded into their
+library (driverlib.lib, c_w.l, libc.a) in the object table and budget.
+"""
+import argparse
+import collections
+import json
+import os
+import re
+import sys
+
+BUDGET = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'footprint_budget.json')
+RAM_BASE = 0x20000000
+PADDING = '<padding>'
+HEADROOM_PCT = 10
+
+# driverlib API prefixes; seeing these in an application object means a
+# driverlib source was compiled in directly (main.c includes driverlib/gpio.c)
+DRIVERLIB = re.compile(r'_?(GPIO|SysCtl|Int|Timer|PWM|ADC|EEPROM)[A-Z]|g_pp?ui32')
+
+# Short notes for symbols that reliably show up at the top of the RAM list
+HINTS = {
+    'ucHeap': 'heap_4 arena, sized by configTOTAL_HEAP_SIZE; check '
+              'xMinimumEverFreeBytesRemaining before shrinking it',
+    'vtable': 'driverlib IntRegister() copies the vector table to RAM and '
+              'aligns it to 1 KB; registering handlers in the startup table saves both',
+    'STACK': 'main stack from the startup file (Stack_Size), used by ISRs '
+             'once the scheduler runs',
+    'HEAP': 'C library heap from the startup file (Heap_Size)',
+}
+
+Section = collections.namedtuple('Section', 'name obj size flash ram')
+
+KEIL_ROW = re.compile(r'\s+0x([0-9a-f]+)\s+(?:0x[0-9a-f]+|COMPRESSED|-)\s+0x([0-9a-f]+)\s+'
+                      r'(Code|Data|Zero|PAD)\b(.*)$')
+KEIL_REGION = re.compile(r'\s+Execution Region \S+ \(Exec base: 0x([0-9a-f]+)')
+KEIL_REMOVED = re.compile(r'\s+Removing (\S+?)\((\S+)\), \((\d+) bytes\)')
+GCC_OUTPUT = re.compile(r'(\.\S+|COMMON)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+))?(.*)$')
+GCC_INPUT = re.compile(r' (\.\S+|COMMON|\*fill\*)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s*(\S.*)?)?$')
+GCC_CONT = re.compile(r'\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$')
+GCC_SKIP = ('.debug', '.comment', '.ARM.attributes', '.stab', '.note', '.gnu')
+
+
+def parse_keil(lines):
+    sections, removed = [], []
+    in_ram = False
+    for line in lines:
+        m = KEIL_REGION.match(line)
+        if m:
+            in_ram = int(m.group(1), 16) >= RAM_BASE
+            continue
+        m = KEIL_REMOVED.match(line)
+        if m:
+            removed.append(Section(m.group(2), m.group(1), int(m.group(3)), 0, 0))
+            continue
+        m = KEIL_ROW.match(line)
+        if not m:
+            continue
+        size, kind = int(m.group(2), 16), m.group(3)
+        if kind == 'PAD':
+            name, obj = PADDING, PADDING
+        else:
+            fields = m.group(4).split()
+            # Attr Idx [E] Section Object
+            name, obj = fields[-2], fields[-1]
+        ram = size if in_ram else 0
+        flash = 0 if kind == 'Zero' or (in_ram and kind == 'PAD') else size
+        sections.append(Section(name, obj, size, flash, ram))
+    return sections, removed
+
+
+def parse_gcc(lines):
+    sections = []
+    output = None
+    pending = None
+    started = False
+    for line in lines:
+        if not started:
+            started = line.startswith('Linker script and memory map')
+            continue
+        if line and not line[0].isspace():
+            m = GCC_OUTPUT.match(line)
+            output = None
+            if m and not m.group(1).startswith(GCC_SKIP):
+                output = m.group(1)
+                loaded = 'load address' in line
+                in_ram = m.group(2) is not None and int(m.group(2), 16) >= RAM_BASE
+                output = (output, in_ram, loaded)
+            pending = None
+            continue
+        if output is None:
+            continue
+        name, in_ram, loaded = output
+        m = GCC_INPUT.match(line)
+        if m:
+            if m.group(2) is None:
+                # Long section names wrap the address, size and object onto the next line
+                pending = m.group(1)
+                continue
+            section, size, obj = m.group(1), int(m.group(3), 16), m.group(4) or ''
+        elif pending:
+            m = GCC_CONT.match(line)
+            pending, section = None, pending
+            if not m:
+                continue
+            size, obj = int(m.group(2), 16), m.group(3)
+        else:
+            continue
+        if size == 0:
+            continue
+        if section == '*fill*':
+            section, obj = PADDING, PADDING
+        zeroed = name.startswith(('.bss', '.noinit', '._user_heap_stack', '.heap', '.stack'))
+        flash = 0 if zeroed or (in_ram and not loaded) else size
+        sections.append(Section(section, object_name(obj), size, flash, size if in_ram else 0))
+    return sections, []
+
+
+def object_name(path):
+    """Drop directories: Objects/main.o -> main.o, .../libc.a(memset.o) -> libc.a(memset.o)."""
+    path = path.strip()
+    m = re.match(r'(.*?)([^/\\]+\.(?:a|lib|l))\((.+)\)$', path)
+    if m:
+        return '%s(%s)' % (m.group(2), m.group(3))
+    return re.split(r'[/\\]', path)[-1]
+
+
+def library(obj):
+    """driverlib.lib(gpio.o) -> driverlib.lib; plain objects are their own module."""
+    return obj.split('(', 1)[0]
+
+
+def symbol(section):
+    """.text.GPIOPadConfigSet / i.IntEnable / .bss.ucHeap -> the symbol name."""
+    for prefix in ('.text.', '.rodata.', '.data.', '.bss.', '.constdata.', 'i.'):
+        if section.startswith(prefix) and len(section) > len(prefix):
+            return section[len(prefix):]
+    return section
+
+
+def totals(sections, key):
+    out = collections.defaultdict(lambda: [0, 0])
+    for s in sections:
+        out[key(s)][0] += s.flash
+        out[key(s)][1] += s.ram
+    return out
+
+
+def findings(sections, removed, ram_total):
+    notes = []
+    for obj in sorted(set(s.obj for s in sections)):
+        if '(' in obj or obj == PADDING:
+            continue
+        pulled = [s for s in sections if s.obj == obj and DRIVERLIB.match(symbol(s.name))]
+        if pulled:
+            size = sum(s.flash for s in pulled)
+            dropped = sum(s.size for s in removed if s.obj == obj and DRIVERLIB.match(symbol(s.name))
+                          and not s.name.startswith('.ARM.exidx'))
+            text = '%s carries %d bytes of driverlib in %d sections (%s)' % (
+                obj, size, len(pulled), ', '.join(symbol(s.name) for s in pulled[:4]) + (
+                    ', ...' if len(pulled) > 4 else ''))
+            if dropped:
+                text += '; %d more bytes compiled in and dropped as unused' % dropped
+            notes.append(text + ': link driverlib.lib instead of including its sources')
+
+    for s in sorted((s for s in sections if s.obj != PADDING), key=lambda s: -s.ram):
+        if s.ram < max(64, ram_total // 10):
+            break
+        name = symbol(s.name)
+        text = '%s (%s) is %d bytes, %.0f%% of RAM' % (name, s.obj, s.ram, 100.0 * s.ram / ram_total)
+        if name in HINTS:
+            text += ': ' + HINTS[name]
+        notes.append(text)
+
+    for i, s in enumerate(sections):
+        if s.name == PADDING and s.size >= 64:
+            after = sections[i + 1] if i + 1 < len(sections) else None
+            notes.append('%d bytes of alignment padding%s' % (
+                s.size, ' before %s (%s)' % (symbol(after.name), after.obj) if after else ''))
+    return notes
+
+
+def check(modules, total, budget):
+    """Print actual against budget; return the names that are over."""
+    over = []
+    print('\n%-22s %8s %8s %8s %8s' % ('budget', 'flash', 'limit', 'ram', 'limit'))
+    rows = [('total', total, budget.get('total', {}))]
+    rows += [(name, modules.get(name, (0, 0)), limit) for name, limit in sorted(budget.get('objects', {}).items())]
+    for name, (flash, ram), limit in rows:
+        flash_max, ram_max = limit.get('flash'), limit.get('ram')
+        bad = (flash_max is not None and flash > flash_max) or (ram_max is not None and ram > ram_max)
+        print('%-22s %8d %8s %8d %8s%s' % (name, flash, flash_max, ram, ram_max, '  OVER' if bad else ''))
+        if bad:
+            over.append(name)
+    new = sorted(name for name in modules if name not in budget.get('objects', {}) and name != PADDING)
+    if new:
+        print('not in budget: ' + ', '.join(new))
+    return over
+
+
+def with_headroom(size, pct):
+    """Limit for a measured size: pct on top, rounded up to 16 bytes."""
+    limit = size + (size * pct + 99) // 100
+    return (limit + 15) // 16 * 16
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('map', nargs='?', default='Listings/Finalproject.map')
+    ap.add_argument('--budget', default=BUDGET)
+    ap.add_argument('--symbols', type=int, default=15, help='largest symbols to list (default 15)')
+    ap.add_argument('--update', action='store_true', help='rewrite the budget from this map and enforce it')
+    ap.add_argument('--headroom', type=int, help='percent added to each limit by --update '
+                    '(default: the budget\'s headroom_pct, else %d)' % HEADROOM_PCT)
+    args = ap.parse_args()
+
+    with open(args.map, errors='replace') as f:
+        lines = f.read().splitlines()
+    gcc = any(line.startswith('Linker script and memory map') for line in lines)
+    sections, removed = (parse_gcc if gcc else parse_keil)(lines)
+    if not sections:
+        sys.exit('%s: no sections found' % args.map)
+
+    modules = totals(sections, lambda s: library(s.obj))
+    flash = sum(s.flash for s in sections)
+    ram = sum(s.ram for s in sections)
+    print('# %s (%s): %d bytes flash, %d bytes RAM' % (args.map, 'GNU ld' if gcc else 'armlink', flash, ram))
+
+    print('\n%8s %8s  %s' % ('flash', 'ram', 'object'))
+    for name, (f, r) in sorted(modules.items(), key=lambda kv: -(kv[1][0] + kv[1][1])):
+        print('%8d %8d  %s' % (f, r, name))
+
+    for title, field in (('flash', 'flash'), ('RAM', 'ram')):
+        top = sorted((s for s in sections if getattr(s, field) and s.obj != PADDING),
+                     key=lambda s: -getattr(s, field))[:args.symbols]
+        print('\n%8s  largest %s symbols' % ('bytes', title))
+        for s in top:
+            print('%8d  %s  %s' % (getattr(s, field), symbol(s.name), s.obj))
+
+    notes = findings(sections, removed, ram)
+    if notes:
+        print('\nfindings')
+        for note in notes:
+            print('  - ' + note)
+
+    if args.update:
+        budget = {}
+        if os.path.exists(args.budget):
+            with open(args.budget) as f:
+                budget = json.load(f)
+        pct = args.headroom if args.headroom is not None else budget.get('headroom_pct', HEADROOM_PCT)
+        budget['headroom_pct'] = pct
+        budget['baseline'] = args.map
+        budget['enforce'] = True
+        budget['total'] = {'flash': with_headroom(flash, pct), 'ram': with_headroom(ram, pct)}
+        budget['objects'] = {name: {'flash': with_headroom(f, pct), 'ram': with_headroom(r, pct)}
+                             for name, (f, r) in sorted(modules.items()) if name != PADDING}
+        with open(args.budget, 'w') as f:
+            json.dump(budget, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('\n# wrote %s' % args.budget)
+        return
+
+    if not os.path.exists(args.budget):
+        return
+    with open(args.budget) as f:
+        budget = json.load(f)
+    over = check(modules, (flash, ram), budget)
+    if not budget.get('enforce', True):
+        print('budget not enforced (baseline: %s); re-baseline with --update from a map of this tree'
+              % budget.get('baseline', 'unknown'))
+        return
+    if over:
+        sys.exit('over budget: ' + ', '.join(over))
+
+
+if __name__ == '__main__':
+    main()
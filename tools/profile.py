@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Symbolise PC samples into a flat and caller profile.
+
+Input is either the target ring (Keil: SAVE prof.bin &ProfileLog, &ProfileLog + sizeof(ProfileLog))
+symbolised against Objects/Finalproject.axf, or the text file written by
+window-sim --profile symbolised against the window-sim binary.
+
+Samples land in the function whose code was executing, so inlined helpers
+and macros (Get_Bit, the gpio_fast.h readers) count towards their caller.
+Callers come from the stacked LR, which is exact for leaf functions and
+only a hint once the sampled function has made a call of its own; the
+host profile has no LR and prints the flat view only.
+"""
+import argparse
+import bisect
+import collections
+import shutil
+import struct
+import subprocess
+import sys
+
+PROFILE_MAGIC = 0x464F5250
+PROFILE_SAMPLES = 512
+EXC_RETURN = 0xFFFFFFE0
+
+# Name prefixes folded into one line of the by-library summary
+LIBRARIES = (
+    ('driverlib', ('GPIO', 'Int', 'SysCtl', 'EEPROM', 'PWM', 'ADC', 'Timer')),
+    ('FreeRTOS', ('vTask', 'xTask', 'uxTask', 'pcTask', 'ulTask', 'vQueue', 'xQueue', 'uxQueue',
+                  'prv', 'pvPort', 'vPort', 'xPort', 'ulPort', 'PendSV_Handler', 'SVC_Handler',
+                  'SysTick_Handler', 'vList', 'uxList')),
+    ('C library', ('__', 'mem', 'str')),
+)
+
+
+def read_samples(path):
+    """Return ([(pc, lr)], rate_hz, relocation anchor or None, handler samples)."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if len(data) >= 16 and struct.unpack_from('<I', data, 0)[0] == PROFILE_MAGIC:
+        _, count, rate, handler = struct.unpack_from('<4I', data, 0)
+        count = min(count, PROFILE_SAMPLES)
+        return [struct.unpack_from('<II', data, 16 + 8 * i) for i in range(count)], rate, None, handler
+    samples, rate, anchor = [], 0, None
+    for line in data.decode().splitlines():
+        if line.startswith('# rate'):
+            rate = int(line.split()[2])
+        elif line.startswith('# main'):
+            anchor = int(line.split()[2], 16)
+        elif line and not line.startswith('#'):
+            pc, lr = line.split()
+            samples.append((int(pc, 16), int(lr, 16)))
+    return samples, rate, anchor, None
+
+
+def read_symbols(elf, nm):
+    if nm is None:
+        nm = 'nm'
+        for tool in ('arm-none-eabi-nm', 'llvm-nm'):
+            if shutil.which(tool):
+                nm = tool
+                break
+    out = subprocess.run([nm, '-n', '-C', '--defined-only', elf], check=True,
+                         capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 2)
+        if len(parts) == 3 and parts[1] in 'TtWw':
+            # Thumb symbols carry bit 0
+            symbols.append((int(parts[0], 16) & ~1, parts[2]))
+    symbols.sort()
+    return [a for a, _ in symbols], [n for _, n in symbols]
+
+
+class Symboliser:
+    def __init__(self, addrs, names, offset):
+        self.addrs, self.names, self.offset = addrs, names, offset
+
+    def __call__(self, address):
+        i = bisect.bisect_right(self.addrs, address - self.offset) - 1
+        return self.names[i] if i >= 0 else '0x%x' % address
+
+
+def library(name):
+    for lib, prefixes in LIBRARIES:
+        if name.startswith(prefixes):
+            return lib
+    return 'application'
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('samples')
+    ap.add_argument('elf', help='Objects/Finalproject.axf or the window-sim binary')
+    ap.add_argument('--nm', help='nm to use (default arm-none-eabi-nm, llvm-nm or nm)')
+    ap.add_argument('--top', type=int, default=25)
+    args = ap.parse_args()
+
+    samples, rate, anchor, handler = read_samples(args.samples)
+    if not samples:
+        sys.exit('no samples')
+    addrs, names = read_symbols(args.elf, args.nm)
+    offset = 0
+    if anchor is not None and 'main' in names:
+        offset = anchor - addrs[names.index('main')]
+    where = Symboliser(addrs, names, offset)
+
+    total = len(samples)
+    flat = collections.Counter()
+    callers = collections.defaultdict(collections.Counter)
+    for pc, lr in samples:
+        fn = where(pc & ~1)
+        flat[fn] += 1
+        if lr >= EXC_RETURN:
+            callers[fn]['<exception entry>'] += 1
+        elif lr:
+            callers[fn][where((lr & ~1) - 2)] += 1
+
+    print('# %d samples at %d Hz (%.2f s)' % (total, rate, total / rate if rate else 0))
+    if handler is not None:
+        print('# %.1f%% on the main stack (ISRs, before the scheduler)' % (100.0 * handler / total))
+
+    print('\n%7s %6s  %s' % ('samples', '%', 'function'))
+    for fn, n in flat.most_common(args.top):
+        print('%7d %6.1f  %s' % (n, 100.0 * n / total, fn))
+
+    by_lib = collections.Counter()
+    for fn, n in flat.items():
+        by_lib[library(fn)] += n
+    print('\n%7s %6s  %s' % ('samples', '%', 'library'))
+    for lib, n in by_lib.most_common():
+        print('%7d %6.1f  %s' % (n, 100.0 * n / total, lib))
+
+    if callers:
+        print('\ncallers (from stacked LR)')
+        for fn, n in flat.most_common(args.top):
+            print('%7d %6.1f  %s' % (n, 100.0 * n / total, fn))
+            for caller, m in callers[fn].most_common(5):
+                print('%7d %6s    <- %s' % (m, '', caller))
+
+
+if __name__ == '__main__':
+    main()
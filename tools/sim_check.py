@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Run the host simulator through its scenarios and check the metrics.
+
+Each scenario is one window-sim run (see sim/sim.c) with the key=value
+summary checked against limits taken from the firmware's configuration:
+the jam reversal is CONFIG_JAM_REVERSE_MS, the hang recovery is bounded by
+LIVENESS_LIMIT_MS, the supervisor period and two WDT_TIMEOUT_MS. The sim runs
+the firmware's own controller and motion task, so a failure here is a
+firmware failure. Exits non-zero when any check fails.
+
+Unless --sim names a binary, the simulator is built first with the cc
+line documented at the top of sim/sim.c, so a build line that has fallen
+behind the source list fails here rather than for the next reader.
+"""
+import argparse
+import os
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SIM_SOURCE = os.path.join(ROOT, 'sim', 'sim.c')
+
+JAM_REVERSE_MS = 500            # CONFIG_JAM_REVERSE_MS
+JAM_REVERSE_SLACK_MS = 20       # a profile period either side
+LIVENESS_LIMIT_MS = 1000        # watchdog.h
+WDT_SUPERVISOR_PERIOD_MS = 100
+WDT_TIMEOUT_MS = 250
+LIVE_INPUT = 0x1                # CheckButtons
+
+# The supervisor notices within a period, then WDT0 runs out twice
+HANG_RESET_MAX_MS = LIVENESS_LIMIT_MS + WDT_SUPERVISOR_PERIOD_MS + 2 * WDT_TIMEOUT_MS
+
+
+def build(out_dir):
+    with open(SIM_SOURCE) as f:
+        lines = [l[2:].strip() for l in f if l.startswith('//   cc ')]
+    if len(lines) != 1:
+        sys.exit('%s: expected one documented cc line, found %d' % (SIM_SOURCE, len(lines)))
+    sim = os.path.join(out_dir, 'window-sim')
+    cmd, n = re.subn(r'-o\s+\S+', '-o ' + shlex.quote(sim), lines[0])
+    if n != 1:
+        sys.exit('%s: documented cc line has no -o' % SIM_SOURCE)
+    print('# ' + lines[0])
+    # As a reader would run it: from the repository root, through the shell
+    if subprocess.run(cmd, shell=True, cwd=ROOT).returncode != 0:
+        sys.exit('documented build line failed')
+    return sim
+
+
+def run(sim, args):
+    out = subprocess.run([sim] + args, check=True, capture_output=True, text=True).stdout
+    metrics = {}
+    for line in out.splitlines():
+        key, sep, value = line.partition('=')
+        if sep:
+            metrics[key] = value.split()[0]
+    return metrics
+
+
+def between(lo, hi):
+    return lambda v: lo <= float(v) <= hi, '%g..%g' % (lo, hi)
+
+
+def equals(want):
+    return lambda v: v == str(want), '== %s' % want
+
+
+def above(lo):
+    return lambda v: float(v) > lo, '> %g' % lo
+
+
+# name, arguments, {metric: check}
+SCENARIOS = [
+    ('default run, one close and open of an unlearned window', [], {
+        'travel_close_ms': above(0),
+        'strokes': equals(2),
+        'learned_up_ms': above(0),
+        'learned_down_ms': above(0),
+        'travel_writes': equals(1),
+        'stalls': equals(0),
+    }),
+    ('jam input during a one-touch close', ['--jam', '3000', '--duration', '10'], {
+        'jam_reverse_ms': between(JAM_REVERSE_MS - JAM_REVERSE_SLACK_MS, JAM_REVERSE_MS + JAM_REVERSE_SLACK_MS),
+        'jam_reverse_mm': above(0),
+        'watchdog_resets': equals(0),
+    }),
+    ('obstacle during a one-touch close', ['--obstacle', '300', '--duration', '10'], {
+        'jams': equals(1),
+        'jam_reverse_ms': between(JAM_REVERSE_MS - JAM_REVERSE_SLACK_MS, JAM_REVERSE_MS + JAM_REVERSE_SLACK_MS),
+        'jam_reverse_mm': above(0),
+    }),
+    ('input task hang', ['--hang', '2000', '--duration', '10'], {
+        'watchdog_resets': equals(1),
+        'watchdog_recoveries': equals(1),
+        'watchdog_missing': equals(hex(LIVE_INPUT)),
+        'stalls': equals(0),
+        'hang_to_reset_ms': between(LIVENESS_LIMIT_MS, HANG_RESET_MAX_MS),
+        'hang_to_responsive_ms': between(LIVENESS_LIMIT_MS, HANG_RESET_MAX_MS + 10),
+    }),
+]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('--sim', help='simulator binary (default: build it from the line in sim/sim.c)')
+    args = ap.parse_args()
+
+    tmp = None
+    if args.sim is None:
+        tmp = tempfile.TemporaryDirectory()
+        args.sim = build(tmp.name)
+
+    failed = 0
+    for name, sim_args, checks in SCENARIOS:
+        metrics = run(args.sim, sim_args)
+        print('# %s: %s' % (name, ' '.join(sim_args)))
+        for key, (ok, want) in checks.items():
+            value = metrics.get(key)
+            good = value is not None and ok(value)
+            failed += not good
+            print('%-4s %s=%s (want %s)' % ('ok' if good else 'FAIL', key, value, want))
+    if failed:
+        sys.exit('%d check(s) failed' % failed)
+
+
+if __name__ == '__main__':
+    main()
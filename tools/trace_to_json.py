@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Convert a TraceLog dump into Chrome/Perfetto trace JSON.
+
+The dump is the RAM ring (Keil: SAVE trace.bin &TraceLog, &TraceLog + sizeof(TraceLog)).
+Open the output in ui.perfetto.dev or chrome://tracing: one track per task
+showing when it ran, an ISR track, deferred work slices (jamHandler, ...)
+on the controller task and instants for queue and notification traffic.
+
+Stamps are DWT cycles at whatever clock was running (clock.h switches
+between two); TRACE_CLOCK records carry every switch and the header
+holds the clock at dump time, so each stretch converts at its own rate.
+
+A preemption summary goes to stderr: who preempted whom, how often and
+for how long, counted from a switch away from a task that had not just
+blocked, delayed or waited on a notification until it runs again.
+"""
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x43525457
+TRACE_SIZE = 512
+TRACE_NAMES = 12
+TRACE_NAME_LEN = 10
+TRACE_IN_ISR = 0xFF
+
+(TRACE_NONE, TRACE_SWITCH, TRACE_CREATE, TRACE_ISR_ENTER, TRACE_ISR_EXIT,
+ TRACE_QUEUE_SEND, TRACE_QUEUE_RECV, TRACE_QUEUE_BLOCK, TRACE_NOTIFY_GIVE,
+ TRACE_NOTIFY_TAKE, TRACE_DELAY, TRACE_WORK_BEGIN, TRACE_WORK_END, TRACE_CLOCK) = range(14)
+
+BLOCKING = (TRACE_QUEUE_BLOCK, TRACE_NOTIFY_TAKE, TRACE_DELAY)
+INSTANTS = {
+    TRACE_QUEUE_SEND: 'send',
+    TRACE_QUEUE_RECV: 'receive',
+    TRACE_QUEUE_BLOCK: 'block',
+    TRACE_NOTIFY_GIVE: 'notify',
+    TRACE_NOTIFY_TAKE: 'wait notify',
+    TRACE_DELAY: 'delay',
+}
+# ISR_WORK_* bit -> handler registered in main()
+WORK = {0: 'jamReverseEnd', 1: 'jamHandler', 2: 'autoModeHandler', 3: 'limitsPoll'}
+# Exception numbers (16 + IRQ) of the handlers registered with isrRegister()
+VECTORS = {15: 'SysTick', 17: 'GPIOB', 46: 'GPIOF'}
+ISR_TID = 1000
+
+
+def read_log(data):
+    magic, head, clock_hz, names = struct.unpack_from('<4I', data, 0)
+    if magic != TRACE_MAGIC:
+        sys.exit('bad magic %#x' % magic)
+    offset = 16
+    tasks = {}
+    for i in range(TRACE_NAMES):
+        number = data[offset]
+        name = data[offset + 1:offset + 2 + TRACE_NAME_LEN].split(b'\0')[0]
+        if i < names:
+            tasks[number] = name.decode('ascii', 'replace')
+        offset += 2 + TRACE_NAME_LEN
+    count = min(head, TRACE_SIZE)
+    start = head - count
+    records = []
+    for i in range(count):
+        records.append(struct.unpack_from('<IBBH', data, offset + 8 * ((start + i) % TRACE_SIZE)))
+    return records, clock_hz, tasks, head - count
+
+
+def first_clock(records, clock_hz):
+    """Clock at the oldest record: the 'from' side of the first TRACE_CLOCK, else the header's."""
+    for _, event, _, arg in records:
+        if event == TRACE_CLOCK:
+            return (arg >> 8) * 1e6
+    return clock_hz
+
+
+def timeline(records, clock_hz):
+    """Yield (us, event, task, arg) with the 32-bit stamp unwrapped.
+
+    The counter runs at the old clock up to a TRACE_CLOCK record and at
+    the new one after it.
+    """
+    now = None
+    last = 0
+    hz = first_clock(records, clock_hz)
+    for cycles, event, task, arg in records:
+        now = 0 if now is None else now + ((cycles - last) & 0xFFFFFFFF) * 1e6 / hz
+        last = cycles
+        if event == TRACE_CLOCK:
+            hz = (arg & 0xFF) * 1e6
+        yield now, event, task, arg
+
+
+def convert(records, clock_hz, tasks):
+    name = lambda task: tasks.get(task, 'task %d' % task)
+    out = [{'ph': 'M', 'name': 'process_name', 'pid': 1, 'args': {'name': 'TM4C123'}},
+           {'ph': 'M', 'name': 'thread_name', 'pid': 1, 'tid': ISR_TID, 'args': {'name': 'ISR'}}]
+    for task in sorted(tasks):
+        out.append({'ph': 'M', 'name': 'thread_name', 'pid': 1, 'tid': task, 'args': {'name': name(task)}})
+
+    running = None
+    since = 0
+    isr = []
+    last_event = {}
+    preempted = {}
+    preemptions = {}
+    for t, event, task, arg in timeline(records, clock_hz):
+        if event == TRACE_SWITCH:
+            if running is not None:
+                out.append({'ph': 'X', 'name': name(running), 'pid': 1, 'tid': running,
+                            'ts': since, 'dur': t - since})
+                if last_event.get(running) not in BLOCKING:
+                    preempted[running] = (task, t)
+            if task in preempted:
+                by, at = preempted.pop(task)
+                key = (by, task)
+                n, total, worst = preemptions.get(key, (0, 0, 0))
+                preemptions[key] = (n + 1, total + t - at, max(worst, t - at))
+            running, since = task, t
+            last_event[task] = event
+        elif event == TRACE_ISR_ENTER:
+            isr.append((t, arg))
+        elif event == TRACE_ISR_EXIT and isr:
+            start, vector = isr.pop()
+            out.append({'ph': 'X', 'name': VECTORS.get(vector, 'vector %d' % vector), 'pid': 1,
+                        'tid': ISR_TID, 'ts': start, 'dur': t - start,
+                        'args': {'switch': bool(arg)}})
+        elif event in (TRACE_WORK_BEGIN, TRACE_WORK_END):
+            out.append({'ph': 'B' if event == TRACE_WORK_BEGIN else 'E',
+                        'name': WORK.get(arg, 'work %d' % arg), 'pid': 1, 'tid': task, 'ts': t})
+        elif event in INSTANTS:
+            args = {'queue': '0x%08x' % (0x20000000 + 4 * arg)} if event <= TRACE_QUEUE_BLOCK else {}
+            if event == TRACE_NOTIFY_GIVE:
+                args = {'task': name(arg)}
+            out.append({'ph': 'i', 's': 't', 'name': INSTANTS[event], 'pid': 1,
+                        'tid': ISR_TID if task == TRACE_IN_ISR else task, 'ts': t, 'args': args})
+            if task != TRACE_IN_ISR:
+                last_event[task] = event
+        elif event == TRACE_CREATE:
+            last_event[task] = event
+        elif event == TRACE_CLOCK:
+            out.append({'ph': 'i', 's': 'g', 'name': 'clock %d MHz' % (arg & 0xFF), 'pid': 1, 'ts': t})
+    return out, {(name(by), name(victim)): (n, total, worst)
+                 for (by, victim), (n, total, worst) in preemptions.items()}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('dump')
+    ap.add_argument('-o', '--output', help='JSON file (default stdout)')
+    ap.add_argument('--clock', type=float,
+                    help='override the recorded SystemCoreClock (dumps without TRACE_CLOCK records)')
+    args = ap.parse_args()
+
+    with open(args.dump, 'rb') as f:
+        records, clock_hz, tasks, lost = read_log(f.read())
+    events, preemptions = convert(records, args.clock or clock_hz, tasks)
+
+    with (open(args.output, 'w') if args.output else sys.stdout) as f:
+        json.dump({'traceEvents': events, 'displayTimeUnit': 'ns'}, f)
+
+    if lost:
+        print('# %d older records overwritten' % lost, file=sys.stderr)
+    for (by, victim), (n, total, worst) in sorted(preemptions.items()):
+        print('%s preempted %s: %d times, %.1f us total, %.1f us max' % (by, victim, n, total, worst),
+              file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,87 @@
+#include <stdint.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "cycles.h"
+#include "trace.h"
+
+#ifdef ENABLE_TRACE
+
+#define ICSR_R (*((volatile uint32_t *)0xE000ED04))
+#define ICSR_VECTACTIVE_M 0x1FFU
+
+extern uint32_t SystemCoreClock;
+
+struct TraceLog TraceLog;
+
+static uint8_t Current;
+static uint8_t Numbered;
+
+// Called before any task is created; the DWT counter is already running
+// from SystemInit (bootStamp) and eventLogInit.
+void traceInit(void){
+	TraceLog.magic = TRACE_MAGIC;
+	TraceLog.head = 0;
+	TraceLog.clockHz = SystemCoreClock;
+	TraceLog.names = 0;
+	Current = 0;
+	Numbered = 0;
+}
+
+static void push(uint32_t event, uint32_t task, uint32_t arg){
+	UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	struct TraceRecord *rec = &TraceLog.records[TraceLog.head & (TRACE_SIZE - 1)];
+	rec->cycles = cyclesNow();
+	rec->event = (uint8_t)event;
+	rec->task = (uint8_t)task;
+	rec->arg = (uint16_t)arg;
+	TraceLog.head++;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+// Safe from tasks, ISRs and the kernel's own critical sections
+void traceRecord(uint32_t event, uint32_t arg){
+	push(event, (ICSR_R & ICSR_VECTACTIVE_M) ? TRACE_IN_ISR : Current, arg);
+}
+
+// Runs in PendSV with the kernel's BASEPRI raised
+void traceSwitchedIn(void *tcb){
+	uint32_t previous = Current;
+	Current = (uint8_t)uxTaskGetTaskNumber((TaskHandle_t)tcb);
+	push(TRACE_SWITCH, Current, previous);
+}
+
+// The kernel leaves every task number at 0 unless it is set, so tasks
+// are numbered from 1 in creation order; 0 stays "before the first task".
+void traceTaskCreate(void *tcb){
+	TaskHandle_t task = (TaskHandle_t)tcb;
+	uint32_t number = ++Numbered;
+	vTaskSetTaskNumber(task, number);
+	if (TraceLog.names < TRACE_NAMES){
+		struct TraceName *name = &TraceLog.name[TraceLog.names++];
+		name->task = (uint8_t)number;
+		strncpy(name->name, pcTaskGetName(task), TRACE_NAME_LEN);
+		name->name[TRACE_NAME_LEN] = '\0';
+	}
+	push(TRACE_CREATE, number, uxTaskPriorityGet(task));
+}
+
+void traceNotifyGive(void *tcb){
+	traceRecord(TRACE_NOTIFY_GIVE, uxTaskGetTaskNumber((TaskHandle_t)tcb));
+}
+
+void traceIsrEnter(void){
+	push(TRACE_ISR_ENTER, TRACE_IN_ISR, ICSR_R & ICSR_VECTACTIVE_M);
+}
+
+void traceIsrExit(uint32_t switched){
+	push(TRACE_ISR_EXIT, TRACE_IN_ISR, switched);
+}
+
+// Stamps before this record counted at fromHz, stamps after it at toHz
+void traceClock(uint32_t fromHz, uint32_t toHz){
+	TraceLog.clockHz = toHz;
+	traceRecord(TRACE_CLOCK, (fromHz / 1000000U) << 8 | (toHz / 1000000U));
+}
+
+#endif
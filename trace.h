@@ -0,0 +1,82 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Kernel trace ring, built with ENABLE_TRACE. Records are 8 bytes: a raw
+// DWT cycle stamp, the event type, the number traceTaskCreate gave the
+// task running when it was taken, and a 16-bit argument. The ring keeps
+// the newest TRACE_SIZE records; dump it with
+//   SAVE trace.bin &TraceLog, &TraceLog + sizeof(TraceLog)
+// and convert with tools/trace_to_json.py, or watch it live in the
+// Component Viewer (EventRecorderStub.scvd).
+#define TRACE_SIZE  512
+#define TRACE_NAMES 12
+#define TRACE_NAME_LEN 10
+#define TRACE_MAGIC 0x43525457UL
+
+enum TraceEvent {
+	TRACE_NONE,
+	TRACE_SWITCH,       // arg: previous task number
+	TRACE_CREATE,       // arg: priority
+	TRACE_ISR_ENTER,    // arg: active vector
+	TRACE_ISR_EXIT,     // arg: 1 if a context switch was requested
+	TRACE_QUEUE_SEND,   // arg: queue id, see TRACE_QUEUE_ID
+	TRACE_QUEUE_RECV,
+	TRACE_QUEUE_BLOCK,
+	TRACE_NOTIFY_GIVE,  // arg: task number notified
+	TRACE_NOTIFY_TAKE,
+	TRACE_DELAY,
+	TRACE_WORK_BEGIN,   // arg: deferred work bit (ISR_WORK_*)
+	TRACE_WORK_END,
+	TRACE_CLOCK         // arg: old MHz << 8 | new MHz, stamped just after the switch
+};
+
+// Task number recorded while an exception handler is running
+#define TRACE_IN_ISR 0xFF
+
+// Queues are named by their word offset into SRAM, fits 16 bits on 32 KB
+#define TRACE_QUEUE_ID(q) ((uint16_t)(((uint32_t)(q) - 0x20000000UL) >> 2))
+
+struct TraceRecord {
+	uint32_t cycles;
+	uint8_t event;
+	uint8_t task;
+	uint16_t arg;
+};
+
+// Task names are captured at creation so the dump is self-describing
+struct TraceName {
+	uint8_t task;
+	char name[TRACE_NAME_LEN + 1];
+};
+
+struct TraceLog {
+	uint32_t magic;
+	uint32_t head;
+	uint32_t clockHz;   // SystemCoreClock now; TRACE_CLOCK marks every change
+	uint32_t names;
+	struct TraceName name[TRACE_NAMES];
+	struct TraceRecord records[TRACE_SIZE];
+};
+
+#ifdef ENABLE_TRACE
+extern struct TraceLog TraceLog;
+
+void traceInit(void);
+void traceRecord(uint32_t event, uint32_t arg);
+void traceSwitchedIn(void *tcb);
+void traceTaskCreate(void *tcb);
+void traceNotifyGive(void *tcb);
+void traceIsrEnter(void);
+void traceIsrExit(uint32_t switched);
+void traceClock(uint32_t fromHz, uint32_t toHz);
+#else
+#define traceInit()
+#define traceRecord(event, arg)
+#define traceIsrEnter()
+#define traceIsrExit(switched)
+#define traceClock(fromHz, toHz)
+#endif
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef TRACE_HOOKS_H
+#define TRACE_HOOKS_H
+
+// Included at the end of FreeRTOSConfig.h when ENABLE_TRACE is set. The
+// kernel expands these inside tasks.c and queue.c, so they may only use
+// names in scope there (pxCurrentTCB, pxNewTCB, pxTCB, pxQueue). The
+// Event Recorder versions from freertos_evr.h are replaced, not chained.
+#include "trace.h"
+
+#undef traceTASK_SWITCHED_IN
+#undef traceTASK_CREATE
+#undef traceQUEUE_SEND
+#undef traceQUEUE_SEND_FROM_ISR
+#undef traceQUEUE_RECEIVE
+#undef traceQUEUE_RECEIVE_FROM_ISR
+#undef traceBLOCKING_ON_QUEUE_RECEIVE
+#undef traceBLOCKING_ON_QUEUE_SEND
+#undef traceTASK_NOTIFY_GIVE_FROM_ISR
+#undef traceTASK_NOTIFY
+#undef traceTASK_NOTIFY_TAKE
+#undef traceTASK_DELAY
+#undef traceTASK_DELAY_UNTIL
+
+#define traceTASK_SWITCHED_IN()                   traceSwitchedIn(pxCurrentTCB)
+#define traceTASK_CREATE(pxNewTCB)                traceTaskCreate(pxNewTCB)
+#define traceQUEUE_SEND(pxQueue)                  traceRecord(TRACE_QUEUE_SEND, TRACE_QUEUE_ID(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)         traceRecord(TRACE_QUEUE_SEND, TRACE_QUEUE_ID(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue)               traceRecord(TRACE_QUEUE_RECV, TRACE_QUEUE_ID(pxQueue))
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)      traceRecord(TRACE_QUEUE_RECV, TRACE_QUEUE_ID(pxQueue))
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)   traceRecord(TRACE_QUEUE_BLOCK, TRACE_QUEUE_ID(pxQueue))
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)      traceRecord(TRACE_QUEUE_BLOCK, TRACE_QUEUE_ID(pxQueue))
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(uxIndex)   traceNotifyGive(pxTCB)
+#define traceTASK_NOTIFY(uxIndex)                 traceNotifyGive(pxTCB)
+#define traceTASK_NOTIFY_TAKE(uxIndex)            traceRecord(TRACE_NOTIFY_TAKE, 0)
+#define traceTASK_DELAY()                         traceRecord(TRACE_DELAY, 0)
+#define traceTASK_DELAY_UNTIL(xTimeToWake)        traceRecord(TRACE_DELAY, 0)
+
+#endif
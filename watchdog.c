@@ -0,0 +1,141 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include "task.h"
+#include "tm4c123gh6pm.h"
+#include "watchdog.h"
+#include "clock.h"
+
+struct Retained Retained __attribute__((section(".ARM.__at_0x20007F00")));
+
+static volatile TickType_t LastSeen[LIVE_SLOTS];
+static uint32_t Expected;
+static StackType_t supervisorStack[100];
+static StaticTask_t supervisorTcb;
+
+static uint32_t retainedCheck(const struct Retained *r){
+	const uint32_t *w = (const uint32_t *)r;
+	uint32_t sum = 0x811C9DC5UL;
+	for(uint32_t i = 0; i < offsetof(struct Retained, check) / sizeof(uint32_t); i++){
+		sum = (sum ^ w[i]) * 16777619UL;
+	}
+	return sum;
+}
+
+#ifdef SIMULATOR
+// Host build: WDT0 and the reset cause come from the simulator
+#include "sim_hw.h"
+#else
+static void wdtKick(void){
+	WATCHDOG0_LOCK_R = WDT_LOCK_UNLOCK;
+	WATCHDOG0_ICR_R = 1;
+	WATCHDOG0_LOCK_R = 1;
+}
+
+// Reloading also restarts the count
+static void wdtLoad(uint32_t ms){
+	WATCHDOG0_LOCK_R = WDT_LOCK_UNLOCK;
+	WATCHDOG0_LOAD_R = (SystemCoreClock / 1000) * ms;
+	WATCHDOG0_LOCK_R = 1;
+}
+
+static void wdtStart(uint32_t ms){
+	SYSCTL_RCGCWD_R |= SYSCTL_RCGCWD_R0;
+	while(!(SYSCTL_PRWD_R & SYSCTL_RCGCWD_R0));
+	
+	WATCHDOG0_LOAD_R = (SystemCoreClock / 1000) * ms;
+	WATCHDOG0_TEST_R |= WDT_TEST_STALL;
+	WATCHDOG0_CTL_R = WDT_CTL_RESEN | WDT_CTL_INTEN;
+	WATCHDOG0_LOCK_R = 1;
+}
+
+// Reads and clears RESC
+static bool wdtCausedReset(void){
+	uint32_t cause = SYSCTL_RESC_R;
+	SYSCTL_RESC_R = 0;
+	return (cause & SYSCTL_RESC_WDT0) != 0;
+}
+#endif
+
+// Fast-boot path: after a watchdog reset the last published window state
+// is taken from retained RAM instead of starting from defaults.
+bool watchdogRecover(struct Window *out){
+	bool byWatchdog = wdtCausedReset();
+	bool valid = Retained.magic == RETAINED_MAGIC && Retained.check == retainedCheck(&Retained);
+	if (!valid){
+		memset(&Retained, 0, sizeof(Retained));
+		Retained.magic = RETAINED_MAGIC;
+		Retained.check = retainedCheck(&Retained);
+		return false;
+	}
+	if (!byWatchdog){
+		return false;
+	}
+	Retained.recoveries++;
+	Retained.check = retainedCheck(&Retained);
+	*out = Retained.window;
+	out->autoMode = false;
+	return true;
+}
+
+// The supervisor's copy of the published state (window.c), taken while
+// every task is alive: up to one supervisor period old after a reset, and
+// never a state written by a task that was already hung
+static void retainWindow(void){
+	struct Window state;
+	windowRead(&state);
+	if (memcmp(&state, &Retained.window, sizeof(state)) != 0){
+		Retained.window = state;
+		Retained.check = retainedCheck(&Retained);
+	}
+}
+
+void watchdogCheckIn(uint32_t live){
+	LastSeen[__builtin_ctz(live)] = xTaskGetTickCount();
+}
+
+// Lowest priority on purpose: a task spinning at any higher priority starves
+// the supervisor as well, and the watchdog then fires.
+static void watchdogSupervisor(void *p){
+	(void)p;
+	TickType_t wake = xTaskGetTickCount();
+	for(;;) {
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(WDT_SUPERVISOR_PERIOD_MS));
+		
+		TickType_t now = xTaskGetTickCount();
+		uint32_t alive = 0;
+		for(uint32_t i = 0; i < LIVE_SLOTS; i++){
+			if ((int32_t)(now - LastSeen[i]) <= (int32_t)pdMS_TO_TICKS(LIVENESS_LIMIT_MS)){
+				alive |= 1U << i;
+			}
+		}
+		
+		if ((alive & Expected) == Expected){
+			wdtKick();
+			retainWindow();
+		}
+		else{
+			Retained.lastMissing = Expected & ~alive;
+			Retained.check = retainedCheck(&Retained);
+		}
+	}
+}
+
+// A clock switch reloads the count, so it doubles as a kick
+static void wdtRederive(void){
+	wdtLoad(WDT_TIMEOUT_MS);
+}
+
+void watchdogInit(uint32_t expected){
+	Expected = expected;
+	for(uint32_t i = 0; i < LIVE_SLOTS; i++){
+		LastSeen[i] = xTaskGetTickCount();
+	}
+	
+	wdtStart(WDT_TIMEOUT_MS);
+	clockSetup(CLOCK_WATCHDOG, wdtRederive);
+	
+	xTaskCreateStatic(watchdogSupervisor, "watchdog", 100, NULL, WDT_SUPERVISOR_PRIORITY, supervisorStack, &supervisorTcb);
+}
@@ -0,0 +1,43 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "window.h"
+
+// WDT0 raises its interrupt after one timeout and resets after the second,
+// so a hang is recovered within 2 * WDT_TIMEOUT_MS plus the boot time.
+#define WDT_TIMEOUT_MS 250
+#define WDT_SUPERVISOR_PERIOD_MS 100
+#define WDT_SUPERVISOR_PRIORITY 1
+
+// Blocking tasks wake at least this often just to check in, a task that
+// has not checked in for LIVENESS_LIMIT_MS counts as hung
+#define LIVENESS_PERIOD_MS 50
+#define LIVENESS_LIMIT_MS 1000
+
+#define LIVE_INPUT      0x01U
+#define LIVE_CONTROLLER 0x02U
+#define LIVE_MOTION     0x04U
+#define LIVE_ALL (LIVE_INPUT | LIVE_CONTROLLER | LIVE_MOTION)
+#define LIVE_SLOTS 8
+
+// Kept in the NoInit IRAM2 region (see Finalproject.uvprojx) so it survives a reset
+#define RETAINED_ADDR 0x20007F00
+#define RETAINED_MAGIC 0x5741544BUL
+
+struct Retained {
+	uint32_t magic;
+	uint32_t recoveries;
+	uint32_t lastMissing;
+	struct Window window;
+	uint32_t check;
+};
+
+extern struct Retained Retained;
+
+bool watchdogRecover(struct Window *out);
+void watchdogInit(uint32_t expected);
+void watchdogCheckIn(uint32_t live);
+
+#endif
@@ -0,0 +1,33 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "window.h"
+
+// Sequence-locked pair of copies. The controller bumps the sequence before
+// rewriting each copy and readers use the copy the sequence does not point
+// the writer at, retrying only if the sequence moved under them. A reader
+// that pre-empts the controller therefore never spins, and no reader ever
+// blocks the writer.
+static volatile uint32_t WindowSeq;
+static struct Window Published[2];
+
+#define seqBarrier() __sync_synchronize()
+
+void windowPublish(const struct Window *state){
+	WindowSeq++;
+	seqBarrier();
+	Published[0] = *state;
+	seqBarrier();
+	WindowSeq++;
+	seqBarrier();
+	Published[1] = *state;
+}
+
+void windowRead(struct Window *out){
+	uint32_t seq;
+	do {
+		seq = WindowSeq;
+		seqBarrier();
+		*out = Published[seq & 1];
+		seqBarrier();
+	} while(seq != WindowSeq);
+}
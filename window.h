@@ -0,0 +1,44 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct Window {
+	bool isFullyClosed;
+	bool isFullyOpened;
+	bool isLocked;
+	bool autoMode;
+};
+
+// Requests to the controller task, the only writer of the window state
+enum WindowMsgType {
+	MSG_INPUTS,
+	MSG_LIMIT,
+	MSG_MOTION_DONE,
+	MSG_PRESET,
+	MSG_TIMEOUT
+};
+
+struct WindowMsg {
+	enum WindowMsgType type;
+	uint32_t arg;
+	uint32_t value;
+};
+
+// Sampled by the controller every TELEMETRY_PERIOD_MS for the watch window
+struct Telemetry {
+	uint32_t samples;
+	uint32_t position;
+	uint32_t heatPct;
+	uint32_t isrLatencyUsMax;
+	uint32_t timerLatencyUsMax;
+	uint32_t queueFreeMin;
+};
+
+extern volatile struct Telemetry Telemetry;
+
+void windowPublish(const struct Window *state);
+void windowRead(struct Window *out);
+
+#endif